@@ -0,0 +1,91 @@
+#include "BackgroundSolver.h"
+#include "Log.h"
+#include <chrono>
+
+BackgroundSolver::BackgroundSolver(const Solver &solver)
+    : solver(solver), request_solver(&solver), request_reduction(NULL), request_version(0), request_id(0),
+      started_id(0), waiting(false), ready(false), stopping(false) {
+    worker = std::thread(&BackgroundSolver::run, this);
+}
+
+BackgroundSolver::~BackgroundSolver() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void BackgroundSolver::request(const CubeState &state, unsigned version, const Solver *with) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        request_state = state;
+        request_solver = with ? with : &solver;
+        request_reduction = NULL;
+        request_version = version;
+        ++request_id;
+        waiting = true;
+        ready = false;
+    }
+    wake.notify_one();
+}
+
+void BackgroundSolver::request(const BigCube &cube, unsigned version, const ReductionSolver &reduction) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        request_big = cube;
+        request_reduction = &reduction;
+        request_version = version;
+        ++request_id;
+        waiting = true;
+        ready = false;
+    }
+    wake.notify_one();
+}
+
+bool BackgroundSolver::poll(SolveResult &out) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!ready) return false;
+    out = result;
+    ready = false;
+    waiting = false;
+    return true;
+}
+
+bool BackgroundSolver::isSolving(unsigned version) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return waiting && request_version == version;
+}
+
+void BackgroundSolver::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this] { return stopping || started_id != request_id; });
+        if (stopping) return;
+
+        unsigned long id = request_id;
+        started_id = id;
+        CubeState state = request_state;
+        const Solver &current = *request_solver;
+        BigCube big = request_big;
+        const ReductionSolver *reduction = request_reduction;
+        SolveResult r;
+        r.version = request_version;
+        lock.unlock();
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (reduction) r.ok = reduction->solve(big, r.big_solution, &r.error);
+        else r.ok = current.solve(state, r.solution, &r.error);
+        r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        lock.lock();
+        if (id != request_id) {
+            LOG_DEBUG("Dropped %s solution for superseded state %u", reduction ? "reduction" : current.name(),
+                      r.version);
+            continue;
+        }
+        result = r;
+        ready = true;
+    }
+}
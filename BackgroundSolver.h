@@ -0,0 +1,65 @@
+#ifndef BACKGROUND_SOLVER_H
+#define BACKGROUND_SOLVER_H
+
+#include "Solver.h"
+#include "ReductionSolver.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct SolveResult {
+    unsigned version;          // as passed to request()
+    bool ok;
+    MoveSequence solution;
+    std::vector<BigMove> big_solution;  // big-cube requests
+    std::string error;
+    double seconds;
+};
+
+// Runs a solver on its own worker thread so the render loop never waits
+// on a search. Each request carries the state version it was taken at; a
+// new request supersedes the one before, whose result is then dropped
+// rather than delivered. A search already under way runs to completion,
+// so keep to solvers that finish in milliseconds.
+class BackgroundSolver {
+public:
+    explicit BackgroundSolver(const Solver &solver);
+    ~BackgroundSolver();
+
+    // Start solving a snapshot; returns immediately. 'with' overrides the
+    // constructor's solver for this request.
+    void request(const CubeState &state, unsigned version, const Solver *with = NULL);
+    // The same for a big cube, solved by reduction into big_solution
+    void request(const BigCube &cube, unsigned version, const ReductionSolver &reduction);
+
+    // The result of the latest request, once, when it is ready
+    bool poll(SolveResult &result);
+
+    // True from request(state, version) until its result is polled
+    bool isSolving(unsigned version) const;
+
+private:
+    void run();
+
+    const Solver &solver;
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+
+    CubeState request_state;
+    const Solver *request_solver;
+    BigCube request_big;
+    const ReductionSolver *request_reduction;   // set for big-cube requests
+    unsigned request_version;
+    unsigned long request_id;      // bumped by every request
+    unsigned long started_id;      // taken by the worker
+    bool waiting;                  // the latest request's result is not yet polled
+    bool ready;
+    SolveResult result;
+    bool stopping;
+
+    BackgroundSolver(const BackgroundSolver &);
+    BackgroundSolver &operator=(const BackgroundSolver &);
+};
+
+#endif // BACKGROUND_SOLVER_H
@@ -0,0 +1,241 @@
+#include "BigCube.h"
+#include <algorithm>
+#include <thread>
+
+BigCube::BigCube(int n) : n(n), threads(std::max(1, int(std::thread::hardware_concurrency()))),
+                          stickers(size_t(6) * n * n) {
+    reset();
+}
+
+void BigCube::reset() {
+    size_t face_size = size_t(n) * n;
+    for (int f = 0; f < 6; ++f) std::fill(stickers.begin() + f * face_size, stickers.begin() + (f + 1) * face_size, f);
+}
+
+bool BigCube::isSolved() const {
+    size_t face_size = size_t(n) * n;
+    for (int f = 0; f < 6; ++f) {
+        const uint8_t *face = &stickers[f * face_size];
+        if (std::find_if(face, face + face_size, [face](uint8_t c) { return c != face[0]; }) != face + face_size)
+            return false;
+    }
+    return true;
+}
+
+// --------------- geometry ---------------------------------------------------
+// Sticker centres in doubled coordinates, so that both odd and even sizes
+// stay on integers: the faces are the planes +-N, rows and columns step by 2.
+// Only used to work out where the rows and columns of a turn go.
+static Vec3i stickerPosition(int n, int face, int row, int col) {
+    return FACE_NORMAL[face] * n + FACE_RIGHT[face] * (2 * col - (n - 1)) + FACE_DOWN[face] * (2 * row - (n - 1));
+}
+
+static Vec3i stickerPosition(int n, size_t index) {
+    size_t face_size = size_t(n) * n;
+    int face = int(index / face_size);
+    int row = int(index % face_size / n), col = int(index % n);
+    return stickerPosition(n, face, row, col);
+}
+
+static int dot(const Vec3i &a, const Vec3i &b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static size_t stickerAt(int n, const Vec3i &p) {
+    int face = 0;
+    for (int a = 0; a < 3; ++a)
+        if (p[a] == n || p[a] == -n) face = a * 2 + (p[a] < 0 ? 1 : 0);
+    int col = (dot(p, FACE_RIGHT[face]) + n - 1) / 2;
+    int row = (dot(p, FACE_DOWN[face]) + n - 1) / 2;
+    return (size_t(face) * n + row) * n + col;
+}
+
+// Quarter turn about a coordinate axis, right-handed when sense is +1
+static Vec3i rotate(const Vec3i &p, int axis, int sense) {
+    switch (axis) {
+        case 0:  return sense > 0 ? Vec3i(p.x, -p.z, p.y) : Vec3i(p.x, p.z, -p.y);
+        case 1:  return sense > 0 ? Vec3i(p.z, p.y, -p.x) : Vec3i(-p.z, p.y, p.x);
+        default: return sense > 0 ? Vec3i(-p.y, p.x, p.z) : Vec3i(p.y, -p.x, p.z);
+    }
+}
+
+Vec3i BigCube::stickerCubie(int n, int face, int row, int col) {
+    Vec3i p = stickerPosition(n, face, row, col) - FACE_NORMAL[face];
+    return Vec3i(layerCoord(n, (p.x + n - 1) / 2), layerCoord(n, (p.y + n - 1) / 2), layerCoord(n, (p.z + n - 1) / 2));
+}
+
+size_t BigCube::turnedSticker(int n, size_t index, int face, int layer, bool clockwise) {
+    int axis = face / 2;
+    Vec3i p = stickerPosition(n, index);
+    Vec3i cubie = p - FACE_NORMAL[int(index / (size_t(n) * n))];
+    if (layerCoord(n, (cubie[axis] + n - 1) / 2) != layer) return index;
+    int sense = (clockwise ? 1 : -1) * ((face & 1) ? -1 : 1);
+    return stickerAt(n, rotate(p, axis, sense));
+}
+
+// --------------- kernels ----------------------------------------------------
+// Splits [0, count) into one range per thread, or runs it inline when the
+// turn moves too few stickers to pay for starting threads
+template <typename Body>
+static void parallelRanges(size_t count, size_t stickers_per_item, int threads, Body body) {
+    if (threads <= 1 || count < 2 || count * stickers_per_item < BIG_CUBE_PARALLEL_STICKERS) {
+        body(size_t(0), count);
+        return;
+    }
+    size_t parts = std::min(count, size_t(threads));
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < parts; ++i)
+        workers.push_back(std::thread(body, count * i / parts, count * (i + 1) / parts));
+    body(size_t(0), count / parts);
+    for (size_t i = 0; i < workers.size(); ++i) workers[i].join();
+}
+
+// Rotates an N x N face a quarter turn in place, as four-element cycles
+// (i, j) -> (j, N-1-i) -> (N-1-i, N-1-j) -> (N-1-j, i) over one quadrant.
+// The quadrant is walked in square tiles so that the four tiles each cycle
+// touches stay in L1, whichever way the rows and columns run.
+static void rotateFace(uint8_t *m, int n, bool clockwise, int threads) {
+    const int B = BIG_CUBE_TILE;
+    int rows = n / 2, cols = (n + 1) / 2;
+    int tile_rows = (rows + B - 1) / B;
+    parallelRanges(size_t(tile_rows), size_t(4) * B * cols, threads, [=](size_t begin, size_t end) {
+        for (int i0 = int(begin) * B; i0 < int(end) * B && i0 < rows; i0 += B) {
+            for (int j0 = 0; j0 < cols; j0 += B) {
+                for (int i = i0; i < std::min(i0 + B, rows); ++i) {
+                    uint8_t *a = m + size_t(i) * n;                    // (i, j) along row i
+                    uint8_t *c = m + size_t(n - 1 - i) * n + (n - 1);  // (N-1-i, N-1-j) backwards
+                    for (int j = j0; j < std::min(j0 + B, cols); ++j) {
+                        uint8_t &b = m[size_t(j) * n + (n - 1 - i)];
+                        uint8_t &d = m[size_t(n - 1 - j) * n + i];
+                        uint8_t t = a[j];
+                        if (clockwise) {
+                            a[j] = d;
+                            d = c[-j];
+                            c[-j] = b;
+                            b = t;
+                        } else {
+                            a[j] = b;
+                            b = c[-j];
+                            c[-j] = d;
+                            d = t;
+                        }
+                    }
+                }
+            }
+        }
+    });
+}
+
+// A row or column of stickers: start + t * stride for t in 0..N-1
+struct StickerLine {
+    size_t start;
+    ptrdiff_t stride;
+};
+
+// Moves the four lines of a slice ring one step along, line k's stickers to
+// line k + 1. Element t of each line goes to element t of the next, so the
+// ring is N independent four-cycles.
+static void cycleLines(uint8_t *s, const StickerLine line[4], int n, int threads) {
+    parallelRanges(size_t(n), 4, threads, [=](size_t begin, size_t end) {
+        uint8_t *p0 = s + line[0].start, *p1 = s + line[1].start;
+        uint8_t *p2 = s + line[2].start, *p3 = s + line[3].start;
+        for (ptrdiff_t t = ptrdiff_t(begin); t < ptrdiff_t(end); ++t) {
+            uint8_t &a = p0[t * line[0].stride], &b = p1[t * line[1].stride];
+            uint8_t &c = p2[t * line[2].stride], &d = p3[t * line[3].stride];
+            uint8_t v = d;
+            d = c;
+            c = b;
+            b = a;
+            a = v;
+        }
+    });
+}
+
+// --------------- turns ------------------------------------------------------
+void BigCube::turn(int face, int layer, bool clockwise) {
+    int axis = face / 2;
+    int sense = (clockwise ? 1 : -1) * ((face & 1) ? -1 : 1);
+    int index = layerIndex(n, layer);
+    if (index < 0 || index >= n) return;
+    uint8_t *s = stickers.data();
+
+    // Outer layers also turn a whole face; which way it looks from outside
+    // follows from where its first sticker goes
+    if (index == 0 || index == n - 1) {
+        int cap = axis * 2 + (index == 0 ? 1 : 0);
+        size_t first = stickerAt(n, rotate(stickerPosition(n, cap, 0, 0), axis, sense));
+        rotateFace(s + size_t(cap) * n * n, n, first % n == size_t(n - 1), threads);
+    }
+
+    // The ring: a row or column of a side face, and its images under the turn
+    int ring = 2 * index - (n - 1);
+    int side = ((axis + 1) % 3) * 2;
+    StickerLine line[4];
+    if (FACE_RIGHT[side][axis] != 0) {
+        int col = (ring * FACE_RIGHT[side][axis] + n - 1) / 2;
+        line[0].start = size_t(side) * n * n + col;
+        line[0].stride = n;
+    } else {
+        int row = (ring * FACE_DOWN[side][axis] + n - 1) / 2;
+        line[0].start = (size_t(side) * n + row) * n;
+        line[0].stride = 1;
+    }
+    for (int k = 1; k < 4; ++k) {
+        const StickerLine &prev = line[k - 1];
+        size_t first = stickerAt(n, rotate(stickerPosition(n, prev.start), axis, sense));
+        size_t second = stickerAt(n, rotate(stickerPosition(n, prev.start + prev.stride), axis, sense));
+        line[k].start = first;
+        line[k].stride = ptrdiff_t(second) - ptrdiff_t(first);
+    }
+    cycleLines(s, line, n, threads);
+}
+
+void BigCube::apply(const BigMove &move) {
+    int face, layer;
+    bool clockwise;
+    int times = bigMoveRotation(n, move, face, layer, clockwise);
+    for (int t = 0; t < times; ++t) turn(face, layer, clockwise);
+}
+
+void BigCube::apply(const std::vector<BigMove> &moves) {
+    for (size_t i = 0; i < moves.size(); ++i) apply(moves[i]);
+}
+
+// --------------- notation ---------------------------------------------------
+// Clockwise seen from a face is -90 degrees about its outward normal, so
+// a named turn is turn(face, layer, false) and its inverse turn(..., true)
+int bigMoveRotation(int n, const BigMove &move, int &face, int &layer, bool &clockwise) {
+    face = move.face;
+    layer = BigCube::layerCoord(n, (move.face & 1) ? move.depth - 1 : n - move.depth);
+    clockwise = move.turns == 3;
+    return move.turns == 2 ? 2 : 1;
+}
+
+BigMove bigMoveForRotation(int n, int face, int layer, bool clockwise) {
+    int index = BigCube::layerIndex(n, layer);
+    int positive = face & ~1, negative = face | 1;
+    BigMove move;
+    move.face = uint8_t(n - index <= index + 1 ? positive : negative);
+    move.depth = uint8_t(move.face == positive ? n - index : index + 1);
+    move.turns = uint8_t((move.face == face) == clockwise ? 3 : 1);
+    return move;
+}
+
+std::string bigMoveName(const BigMove &move) {
+    static const char letters[6] = {'R', 'L', 'U', 'D', 'F', 'B'};
+    std::string name;
+    if (move.depth > 1) name += std::to_string(move.depth);
+    name += letters[move.face % 6];
+    if (move.turns == 2) name += '2';
+    else if (move.turns == 3) name += '\'';
+    return name;
+}
+
+std::string bigMovesToString(const std::vector<BigMove> &moves) {
+    std::string s;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        if (i) s += ' ';
+        s += bigMoveName(moves[i]);
+    }
+    return s;
+}
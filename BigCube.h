@@ -0,0 +1,88 @@
+#ifndef BIG_CUBE_H
+#define BIG_CUBE_H
+
+#include "CubeTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+const int MIN_CUBE_SIZE = 2;
+const int MAX_CUBE_SIZE = 20;           // rendered; BigCube itself has no limit
+
+const int BIG_CUBE_TILE = 32;                               // face rotation tile edge
+const size_t BIG_CUBE_PARALLEL_STICKERS = size_t(1) << 19;  // threads from this many stickers per turn
+
+// A big-cube turn in standard notation: the face it is named after, the
+// layer counted in from that face (1 = the face itself, so "3R" is the
+// third layer from R) and quarter turns clockwise as seen from that face.
+struct BigMove {
+    uint8_t face;
+    uint8_t depth;
+    uint8_t turns;                      // 1, 2 or 3
+};
+
+std::string bigMoveName(const BigMove &move);       // "R", "2U2", "3F'" ...
+std::string bigMovesToString(const std::vector<BigMove> &moves);
+
+// BigCube::turn / RubiksCube::startRotation arguments for a move on an
+// N x N x N cube; returns how many times to apply them
+int bigMoveRotation(int n, const BigMove &move, int &face, int &layer, bool &clockwise);
+// The quarter turn startRotation(face, layer, clockwise) makes, named
+// after the nearer of the two faces on its axis
+BigMove bigMoveForRotation(int n, int face, int layer, bool clockwise);
+
+// Sticker-level N x N x N cube for sizes the cubie model does not cover,
+// up to scaling experiments at N = 1000 and beyond: all it holds is the
+// 6 * N^2 stickers.
+//
+// Each face is an N x N matrix of colours (home faces), rows and columns
+// as in the CubeState facelet numbering: seen from outside, "right" and
+// "down" are FACE_RIGHT and FACE_DOWN. Sticker (face, row, col) is at
+// face * N * N + row * N + col, so a BigCube(3) matches getFacelets().
+//
+// Layers are addressed as by RubiksCube::startRotation: the signed grid
+// coordinate along the face's axis, -N/2 .. N/2, skipping 0 when N is even.
+//
+// Turns work in place. An outer layer rotates its face matrix a quarter
+// turn, tile by tile; every layer moves its ring, four rows or columns of
+// the side faces, as strided four-cycles. Turns that move more than
+// BIG_CUBE_PARALLEL_STICKERS stickers are split across threads.
+class BigCube {
+public:
+    explicit BigCube(int n = 4);
+
+    void reset();
+    int getSize() const { return n; }
+    bool isSolved() const;      // every face one colour
+
+    // Threads for large turns (default: one per core)
+    void setThreads(int count) { threads = count < 1 ? 1 : count; }
+
+    uint8_t sticker(int face, int row, int col) const { return stickers[(size_t(face) * n + row) * n + col]; }
+    const std::vector<uint8_t> &getStickers() const { return stickers; }
+
+    // +90 degrees (clockwise) or -90 degrees about FACE_DIR[face]
+    void turn(int face, int layer, bool clockwise);
+    void apply(const BigMove &move);
+    void apply(const std::vector<BigMove> &moves);
+
+    bool operator==(const BigCube &o) const { return n == o.n && stickers == o.stickers; }
+    bool operator!=(const BigCube &o) const { return !(*this == o); }
+
+    // Layer coordinate <-> index 0..N-1 along the axis
+    static int layerIndex(int n, int layer) { return layer + n / 2 - ((n % 2 == 0 && layer > 0) ? 1 : 0); }
+    static int layerCoord(int n, int index) { return index - n / 2 + ((n % 2 == 0 && index >= n / 2) ? 1 : 0); }
+
+    // Grid position (layer coordinates) of the cubie carrying a sticker
+    static Vec3i stickerCubie(int n, int face, int row, int col);
+    // Where sticker 'index' goes under turn(face, layer, clockwise)
+    static size_t turnedSticker(int n, size_t index, int face, int layer, bool clockwise);
+
+private:
+    int n;
+    int threads;
+    std::vector<uint8_t> stickers;
+};
+
+#endif // BIG_CUBE_H
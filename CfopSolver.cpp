@@ -0,0 +1,451 @@
+#include "CfopSolver.h"
+#include "CubeCoords.h"
+#include <algorithm>
+#include <chrono>
+
+// Last-layer algorithms in the usual case order; checked when the
+// recognition tables are built
+static const char *const OLL_ALGS[] = {
+    "R U2 R2 F R F' U2 R' F R F'",              // 1
+    "r U r' U2 r U2 R' U2 R U' r'",
+    "r' R2 U R' U r U2 r' U M'",
+    "M U' r U2 r' U' R U' R' M'",
+    "l' U2 L U L' U l",                         // 5
+    "r U2 R' U' R U' r'",
+    "r U R' U R U2 r'",
+    "l' U' L U' L' U2 l",
+    "R U R' U' R' F R2 U R' U' F'",
+    "R U R' U R' F R F' R U2 R'",               // 10
+    "r U R' U R' F R F' R U2 r'",
+    "M' R' U' R U' R' U2 R U' R r'",
+    "F U R U' R2 F' R U R U' R'",
+    "R' F R U R' F' R F U' F'",
+    "l' U' l L' U' L U l' U l",                 // 15
+    "r U r' R U R' U' r U' r'",
+    "F R' F' R2 r' U R U' R' U' M'",
+    "r U R' U R U2 r2 U' R U' R' U2 r",
+    "r' R U R U R' U' M' R' F R F'",
+    "r U R' U' M2 U R U' R' U' M'",             // 20
+    "R U2 R' U' R U R' U' R U' R'",
+    "R U2 R2 U' R2 U' R2 U2 R",
+    "R2 D' R U2 R' D R U2 R",
+    "r U R' U' r' F R F'",
+    "F' r U R' U' r' F R",                      // 25
+    "R U2 R' U' R U' R'",
+    "R U R' U R U2 R'",
+    "r U R' U' r' R U R U' R'",
+    "R U R' U' R U' R' F' U' F R U R'",
+    "F R' F R2 U' R' U' R U R' F2",             // 30
+    "R' U' F U R U' R' F' R",
+    "L U F' U' L' U L F L'",
+    "R U R' U' R' F R F'",
+    "R U R2 U' R' F R U R U' F'",
+    "R U2 R2 F R F' R U2 R'",                   // 35
+    "L' U' L U' L' U L U L F' L' F",
+    "F R' F' R U R U' R'",
+    "R U R' U R U' R' U' R' F R F'",
+    "L F' L' U' L U F U' L'",
+    "R' F R U R' U' F' U R",                    // 40
+    "R U R' U R U2 R' F R U R' U' F'",
+    "R' U' R U' R' U2 R F R U R' U' F'",
+    "F' U' L' U L F",
+    "F U R U' R' F'",
+    "F R U R' U' F'",                           // 45
+    "R' U' R' F R F' U R",
+    "R' U' R' F R F' R' F R F' U R",
+    "F R U R' U' R U R' U' F'",
+    "r U' r2 U r2 U r2 U' r",
+    "r' U r2 U' r2 U' r2 U r'",                 // 50
+    "F U R U' R' U R U' R' F'",
+    "R U R' U R U' B U' B' R'",
+    "l' U2 L U L' U' L U L' U l",
+    "r U2 R' U' R U R' U' R U' r'",
+    "R' F R U R U' R2 F' R2 U' R' U R U R'",    // 55
+    "r' U' r U' R' U R U' R' U R r' U r",
+    "R U R' U' M' U R U' r'",
+};
+static const int NUM_OLL = sizeof(OLL_ALGS) / sizeof(OLL_ALGS[0]);
+
+static const char *const PLL_NAMES[] = {
+    "Aa", "Ab", "E", "F", "Ga", "Gb", "Gc", "Gd", "H", "Ja", "Jb",
+    "Na", "Nb", "Ra", "Rb", "T", "Ua", "Ub", "V", "Y", "Z"
+};
+static const char *const PLL_ALGS[] = {
+    "x R' U R' D2 R U' R' D2 R2 x'",
+    "x R2 D2 R U R' D2 R U' R x'",
+    "x' R U' R' D R U R' D' R U R' D R U' R' D' x",
+    "R' U' F' R U R' U' R' F R2 U' R' U' R U R' U R",
+    "R2 U R' U R' U' R U' R2 U' D R' U R D'",
+    "R' U' R U D' R2 U R' U R U' R U' R2 D",
+    "R2 U' R U' R U R' U R2 U D' R U' R' D",
+    "R U R' U' D R2 U' R U' R' U R' U R2 D'",
+    "M2 U M2 U2 M2 U M2",
+    "R' U L' U2 R U' R' U2 R L",
+    "R U R' F' R U R' U' R' F R2 U' R'",
+    "R U R' U R U R' F' R U R' U' R' F R2 U' R' U2 R U' R'",
+    "R' U R U' R' F' U' F R U R' F R' F' R U' R",
+    "R U' R' U' R U R D R' U' R D' R' U2 R'",
+    "R2 F R U R U' R' F' R U2 R' U2 R",
+    "R U R' U' R' F R2 U' R' U' R U R' F'",
+    "M2 U M U2 M' U M2",
+    "M2 U' M U2 M' U' M2",
+    "R U' R U R' D R D' R U' D R2 U R2 D' R2",
+    "F R U' R' U' R U R' F' R U R' U' R' F R F'",
+    "M' U M2 U M2 U M' U2 M2",
+};
+static const int NUM_PLL = sizeof(PLL_ALGS) / sizeof(PLL_ALGS[0]);
+
+static const Move F2L_MOVES[CFOP_NUM_F2L_MOVES] = {
+    MOVE_U, MOVE_U2, MOVE_U3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_F, MOVE_F2, MOVE_F3,
+    MOVE_L, MOVE_L2, MOVE_L3, MOVE_B, MOVE_B2, MOVE_B3
+};
+static const char *const PAIR_NAMES[4] = {"FR", "FL", "BL", "BR"};
+static const int CROSS_EDGES[4] = {DR, DF, DL, DB};
+
+const int MAX_F2L_DEPTH = 14;
+
+// --------------- piece codes ------------------------------------------------
+// Codes of F2L pair k placed: corner DFR + k and edge FR + k home
+static uint32_t pairGoal(int k) {
+    return uint32_t((DFR + k) * 3 * 24 + (FR + k) * 2);
+}
+
+// Table of pairs j < k among the six
+static int pairIndex(int j, int k) {
+    static const int index[4][4] = {{-1, 0, 1, 2}, {0, -1, 3, 4}, {1, 3, -1, 5}, {2, 4, 5, -1}};
+    return index[j][k];
+}
+
+static int cornerCode(const CubeState &s, int cubie) {
+    for (int i = 0; i < NUM_CORNERS; ++i)
+        if (s.cornerCubie(i) == cubie) return i * 3 + s.cornerTwist(i);
+    return 0;
+}
+
+static int edgeCode(const CubeState &s, int cubie) {
+    for (int i = 0; i < NUM_EDGES; ++i)
+        if (s.edgeCubie(i) == cubie) return i * 2 + s.edgeFlip(i);
+    return 0;
+}
+
+int ollKey(const CubeState &s) {
+    int key = 0;
+    for (int i = URF; i <= UBR; ++i) key = key * 3 + s.cornerTwist(i);
+    for (int i = UR; i <= UB; ++i) key = key * 2 + s.edgeFlip(i);
+    return key;
+}
+
+int pllKey(const CubeState &s) {
+    uint8_t corners[4], edges[4];
+    for (int i = 0; i < 4; ++i) {
+        corners[i] = uint8_t(s.cornerCubie(URF + i) & 3);
+        edges[i] = uint8_t(s.edgeCubie(UR + i) & 3);
+    }
+    return permutationRank(corners, 4) * 24 + permutationRank(edges, 4);
+}
+
+// --------------- tables -----------------------------------------------------
+// Index every U-turn variant of each algorithm by the pattern it solves,
+// keeping the shortest sequence per pattern
+static void indexCases(const std::vector<MoveSequence> &algs, int (*key)(const CubeState &), bool post_auf,
+                       LastLayerCase *cases, int num_keys) {
+    std::vector<size_t> length(num_keys, ~size_t(0));
+    for (int k = 0; k < num_keys; ++k) cases[k].alg = -1;
+    for (int a = 0; a < int(algs.size()); ++a) {
+        for (int before = 0; before < 4; ++before) {
+            for (int after = 0; after < (post_auf ? 4 : 1); ++after) {
+                MoveSequence seq;
+                for (int i = 0; i < before; ++i) seq.append(MOVE_U);
+                seq.append(algs[a]);
+                for (int i = 0; i < after; ++i) seq.append(MOVE_U);
+                CubeState s;
+                s.multiply(seq.inverse().permutation());
+                int k = key(s);
+                if (seq.size() >= length[k]) continue;
+                length[k] = seq.size();
+                cases[k].alg = int8_t(a);
+                cases[k].before = uint8_t(before);
+                cases[k].after = uint8_t(after);
+            }
+        }
+    }
+}
+
+static void parseAlgs(const char *const *text, int count, std::vector<MoveSequence> &algs) {
+    algs.resize(count);
+    for (int i = 0; i < count; ++i) algs[i].parse(text[i]);
+}
+
+CfopTables::CfopTables() : sections("cfop/") {
+    for (int m = 0; m < CFOP_NUM_MOVES; ++m) {
+        for (int code = 0; code < 24; ++code) {
+            CubeState s;
+            int corner = code / 3;
+            s.corners[corner] = uint8_t(corner | ((code % 3) << 3));
+            applyMove(s, Move(m));
+            cornerMove[m][code] = uint8_t(cornerCode(s, corner));
+
+            CubeState t;
+            int edge = code / 2;
+            t.edges[edge] = uint8_t(edge | ((code % 2) << 4));
+            applyMove(t, Move(m));
+            edgeMove[m][code] = uint8_t(edgeCode(t, edge));
+        }
+    }
+
+    // The cross as two coordinates of two edges each: DR/DF and DL/DB
+    crossDist = sections.section<uint8_t>("cross_dist", CFOP_CROSS_SIZE, [this](uint8_t *t) {
+        std::vector<uint16_t> pair_move(576 * CFOP_NUM_MOVES);
+        for (int p = 0; p < 576; ++p)
+            for (int m = 0; m < CFOP_NUM_MOVES; ++m)
+                pair_move[p * CFOP_NUM_MOVES + m] = uint16_t(edgeMove[m][p / 24] * 24 + edgeMove[m][p % 24]);
+        uint32_t a = uint32_t(DR * 2 * 24 + DF * 2), b = uint32_t(DL * 2 * 24 + DB * 2);
+        buildPruningTable(t, &pair_move[0], 576, &pair_move[0], 576, CFOP_NUM_MOVES,
+                          std::vector<uint32_t>(1, a * 576 + b));
+    });
+
+    std::vector<uint16_t> corner_move(24 * CFOP_NUM_F2L_MOVES), edge_move(24 * CFOP_NUM_F2L_MOVES);
+    for (int code = 0; code < 24; ++code) {
+        for (int m = 0; m < CFOP_NUM_F2L_MOVES; ++m) {
+            corner_move[code * CFOP_NUM_F2L_MOVES + m] = cornerMove[F2L_MOVES[m]][code];
+            edge_move[code * CFOP_NUM_F2L_MOVES + m] = edgeMove[F2L_MOVES[m]][code];
+        }
+    }
+    for (int k = 0; k < 4; ++k)
+        buildPruningTable(pairDist[k], &corner_move[0], 24, &edge_move[0], 24, CFOP_NUM_F2L_MOVES,
+                          std::vector<uint32_t>(1, pairGoal(k)));
+
+    twoPairDist = sections.section<uint8_t>("two_pair_dist", 6 * CFOP_TWO_PAIR_SIZE, [&](uint8_t *t) {
+        std::vector<uint16_t> pair_move(576 * CFOP_NUM_F2L_MOVES);
+        for (int p = 0; p < 576; ++p)
+            for (int m = 0; m < CFOP_NUM_F2L_MOVES; ++m)
+                pair_move[p * CFOP_NUM_F2L_MOVES + m] = uint16_t(corner_move[(p / 24) * CFOP_NUM_F2L_MOVES + m] * 24 +
+                                                                 edge_move[(p % 24) * CFOP_NUM_F2L_MOVES + m]);
+        for (int j = 0; j < 4; ++j)
+            for (int k = j + 1; k < 4; ++k)
+                buildPruningTable(t + pairIndex(j, k) * CFOP_TWO_PAIR_SIZE, &pair_move[0], 576, &pair_move[0], 576,
+                                  CFOP_NUM_F2L_MOVES, std::vector<uint32_t>(1, pairGoal(j) * 576 + pairGoal(k)));
+    });
+
+    parseAlgs(OLL_ALGS, NUM_OLL, ollAlgs);
+    parseAlgs(PLL_ALGS, NUM_PLL, pllAlgs);
+    indexCases(ollAlgs, ollKey, false, oll, OLL_KEYS);
+    // An empty algorithm covers the cases that need only U turns
+    pllAlgs.push_back(MoveSequence());
+    indexCases(pllAlgs, pllKey, true, pll, PLL_KEYS);
+}
+
+const CfopTables &cfopTables() {
+    static const CfopTables tables;
+    return tables;
+}
+
+// --------------- F2L search -------------------------------------------------
+namespace {
+
+inline bool redundant(int move, int last) {
+    if (last < 0) return false;
+    int face = moveTurn(move), last_face = moveTurn(last);
+    return face == last_face || (face % 3 == last_face % 3 && face < last_face);
+}
+
+struct Pieces {
+    uint8_t cross[4];
+    uint8_t corner[4];
+    uint8_t edge[4];
+
+    explicit Pieces(const CubeState &s) {
+        for (int k = 0; k < 4; ++k) {
+            cross[k] = uint8_t(edgeCode(s, CROSS_EDGES[k]));
+            corner[k] = uint8_t(cornerCode(s, DFR + k));
+            edge[k] = uint8_t(edgeCode(s, FR + k));
+        }
+    }
+
+    Pieces(const Pieces &p, const CfopTables &t, Move m) {
+        for (int k = 0; k < 4; ++k) {
+            cross[k] = t.edgeMove[m][p.cross[k]];
+            corner[k] = t.cornerMove[m][p.corner[k]];
+            edge[k] = t.edgeMove[m][p.edge[k]];
+        }
+    }
+
+    int crossDistance(const CfopTables &t) const {
+        return t.crossDist[((cross[0] * 24 + cross[1]) * 24 + cross[2]) * 24 + cross[3]];
+    }
+
+    int pair(int k) const { return corner[k] * 24 + edge[k]; }
+
+    int pairDistance(const CfopTables &t, int k) const {
+        return t.pairDist[k][pair(k)];
+    }
+
+    int twoPairDistance(const CfopTables &t, int j, int k) const {
+        if (j > k) std::swap(j, k);
+        return t.twoPairDist[pairIndex(j, k) * CFOP_TWO_PAIR_SIZE + pair(j) * 576 + pair(k)];
+    }
+};
+
+// Inserts one more pair, whichever is quickest, keeping the cross and the
+// pairs in 'placed'
+struct F2LSearch {
+    const CfopTables &t;
+    unsigned placed;
+    Move path[MAX_F2L_DEPTH];
+    int inserted;
+
+    F2LSearch(const CfopTables &t, unsigned placed) : t(t), placed(placed), inserted(-1) {}
+
+    // Moves needed at least; 0 exactly when one more pair is in. Each
+    // candidate pair is measured together with every pair to be kept.
+    int distance(const Pieces &p) const {
+        int kept = p.crossDistance(t), next = MAX_F2L_DEPTH + 1;
+        for (int k = 0; k < 4; ++k) {
+            if (placed & (1u << k)) {
+                kept = std::max(kept, p.pairDistance(t, k));
+                continue;
+            }
+            int d = p.pairDistance(t, k);
+            for (int j = 0; j < 4 && d < next; ++j)
+                if (placed & (1u << j)) d = std::max(d, p.twoPairDistance(t, j, k));
+            next = std::min(next, d);
+        }
+        return std::max(kept, next);
+    }
+
+    int run(const Pieces &start) {
+        for (int depth = distance(start); depth <= MAX_F2L_DEPTH; ++depth)
+            if (search(start, 0, depth)) return depth;
+        return -1;
+    }
+
+    bool search(const Pieces &p, int depth, int togo) {
+        if (togo == 0) {
+            for (int k = 0; k < 4; ++k)
+                if (!(placed & (1u << k)) && p.pairDistance(t, k) == 0) inserted = k;
+            return true;
+        }
+        for (int m = 0; m < CFOP_NUM_F2L_MOVES; ++m) {
+            Move move = F2L_MOVES[m];
+            if (depth > 0 && redundant(move, path[depth - 1])) continue;
+            Pieces next(p, t, move);
+            if (distance(next) >= togo) continue;
+            path[depth] = move;
+            if (search(next, depth + 1, togo - 1)) return true;
+        }
+        return false;
+    }
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void addStage(std::vector<CfopStage> *stages, const std::string &name, const MoveSequence &moves,
+              std::chrono::steady_clock::time_point start) {
+    if (!stages) return;
+    CfopStage stage = {name, moves, secondsSince(start)};
+    stages->push_back(stage);
+}
+
+} // namespace
+
+// --------------- solver -----------------------------------------------------
+CfopSolver::CfopSolver() {
+    cfopTables();
+}
+
+bool CfopSolver::solve(const CubeState &state, MoveSequence &solution, std::string *error) const {
+    return solve(state, solution, error, NULL);
+}
+
+bool CfopSolver::solve(const CubeState &state, MoveSequence &solution, std::string *error,
+                       std::vector<CfopStage> *stages) const {
+    if (!checkSolvable(state, error)) return false;
+    const CfopTables &t = cfopTables();
+    if (stages) stages->clear();
+
+    CubeState s = state;
+    MoveSequence result;
+
+    // Cross: walk the distance table down
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    MoveSequence cross;
+    orientCenters(s, cross);
+    Pieces p(s);
+    for (int d = p.crossDistance(t); d > 0; --d) {
+        for (int m = 0; m < CFOP_NUM_MOVES; ++m) {
+            Pieces next(p, t, Move(m));
+            if (next.crossDistance(t) == d - 1) {
+                p = next;
+                applyMove(s, Move(m));
+                cross.append(Move(m));
+                break;
+            }
+        }
+    }
+    addStage(stages, "cross", cross, start);
+    result.append(cross);
+
+    // F2L, one pair at a time
+    unsigned placed = 0;
+    for (int k = 0; k < 4; ++k)
+        if (p.pairDistance(t, k) == 0) placed |= 1u << k;
+    while (placed != 15) {
+        start = std::chrono::steady_clock::now();
+        F2LSearch search(t, placed);
+        int length = search.run(Pieces(s));
+        if (length < 0) {
+            if (error) *error = "no F2L insertion found";
+            return false;
+        }
+        MoveSequence pair;
+        for (int i = 0; i < length; ++i) pair.append(search.path[i]);
+        applyMoves(s, search.path, length);
+        p = Pieces(s);
+        for (int k = 0; k < 4; ++k)
+            if (p.pairDistance(t, k) == 0) placed |= 1u << k;
+        addStage(stages, std::string("F2L ") + PAIR_NAMES[search.inserted], pair, start);
+        result.append(pair);
+    }
+
+    // Last layer: one lookup per step
+    start = std::chrono::steady_clock::now();
+    MoveSequence oll;
+    std::string oll_name = "OLL skip";
+    if (ollKey(s) != 0) {
+        const LastLayerCase &c = t.oll[ollKey(s)];
+        if (c.alg < 0) {
+            if (error) *error = "unrecognised OLL case";
+            return false;
+        }
+        for (int i = 0; i < c.before; ++i) oll.append(MOVE_U);
+        oll.append(t.ollAlgs[c.alg]);
+        s.multiply(oll.permutation());
+        oll_name = "OLL " + std::to_string(c.alg + 1);
+    }
+    addStage(stages, oll_name, oll, start);
+    result.append(oll);
+
+    start = std::chrono::steady_clock::now();
+    const LastLayerCase &c = t.pll[pllKey(s)];
+    if (c.alg < 0) {
+        if (error) *error = "unrecognised PLL case";
+        return false;
+    }
+    MoveSequence pll;
+    for (int i = 0; i < c.before; ++i) pll.append(MOVE_U);
+    pll.append(t.pllAlgs[c.alg]);
+    for (int i = 0; i < c.after; ++i) pll.append(MOVE_U);
+    s.multiply(pll.permutation());
+    std::string pll_name = c.alg < NUM_PLL ? std::string("PLL ") + PLL_NAMES[c.alg] : pll.empty() ? "PLL skip" : "AUF";
+    addStage(stages, pll_name, pll, start);
+    result.append(pll);
+
+    if (!s.isSolved()) {
+        if (error) *error = "last layer not solved";
+        return false;
+    }
+    solution = result;
+    return true;
+}
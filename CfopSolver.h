@@ -0,0 +1,81 @@
+#ifndef CFOP_SOLVER_H
+#define CFOP_SOLVER_H
+
+#include "Solver.h"
+#include "TableFile.h"
+#include <vector>
+
+// CFOP, the method most people solve by hand: cross on D, the four F2L
+// corner/edge pairs, then orient (OLL) and permute (PLL) the last layer.
+//
+// The cross is solved optimally from a distance table over the four D
+// edges. Each F2L step is a short IDA* over U, R, L, F and B that inserts
+// whichever remaining pair is quickest while keeping the cross and the
+// pairs already placed. The last layer is solved from the standard
+// 57 OLL and 21 PLL algorithms: every case, in every U-turn variant, is
+// indexed by its top-layer pattern (corner twists and edge flips for OLL,
+// corner and edge permutation for PLL), so recognition is one table
+// lookup rather than a trial of each algorithm.
+const int CFOP_NUM_MOVES = 18;
+const int CFOP_NUM_F2L_MOVES = 15;      // U, R, F, L, B
+const int CFOP_CROSS_SIZE = 24 * 24 * 24 * 24;
+const int CFOP_TWO_PAIR_SIZE = 576 * 576;
+
+// A last-layer case as found by recognition: U turns, algorithm, U turns
+struct LastLayerCase {
+    int8_t alg;                         // index into the OLL or PLL list, -1 = no case
+    uint8_t before;                     // U turns first
+    uint8_t after;                      // U turns last (PLL only)
+};
+
+const int OLL_KEYS = 81 * 16;           // 3^4 corner twists * 2^4 edge flips
+const int PLL_KEYS = 24 * 24;           // corner * edge permutation of the U layer
+
+struct CfopTables {
+    // Piece codes, slot * 3 + twist for corners and slot * 2 + flip for
+    // edges, after each face move
+    uint8_t cornerMove[CFOP_NUM_MOVES][24];
+    uint8_t edgeMove[CFOP_NUM_MOVES][24];
+
+    // Cross distances by the codes of edges DR, DF, DL, DB
+    const uint8_t *crossDist;
+    // F2L pair distances over F2L moves, [slot][corner code * 24 + edge code],
+    // and for each two pairs j < k at once, [pair j * 576 + pair k] in order
+    // 01, 02, 03, 12, 13, 23
+    uint8_t pairDist[4][24 * 24];
+    const uint8_t *twoPairDist;
+
+    LastLayerCase oll[OLL_KEYS];
+    LastLayerCase pll[PLL_KEYS];
+    std::vector<MoveSequence> ollAlgs, pllAlgs;
+
+    TableSet sections;                  // cross and two-pair tables (2.2 MB), mapped or generated
+
+    CfopTables();
+};
+
+const CfopTables &cfopTables();
+
+// Top-layer pattern keys; pieces outside the U layer are ignored
+int ollKey(const CubeState &state);
+int pllKey(const CubeState &state);
+
+struct CfopStage {
+    std::string name;                   // "cross", "F2L FR", "OLL 27", "PLL T" ...
+    MoveSequence moves;
+    double seconds;
+};
+
+class CfopSolver : public Solver {
+public:
+    CfopSolver();
+
+    const char *name() const { return "cfop"; }
+    bool solve(const CubeState &state, MoveSequence &solution, std::string *error = NULL) const;
+
+    // Also reports the moves and time of each stage
+    bool solve(const CubeState &state, MoveSequence &solution, std::string *error,
+               std::vector<CfopStage> *stages) const;
+};
+
+#endif // CFOP_SOLVER_H
@@ -0,0 +1,187 @@
+#include "CubeCoords.h"
+#include <cstring>
+
+// --------------- combinatorics ----------------------------------------------
+int binomial(int n, int k) {
+    if (k < 0 || k > n) return 0;
+    int r = 1;
+    for (int i = 1; i <= k; ++i) r = r * (n - k + i) / i;
+    return r;
+}
+
+int permutationRank(const uint8_t *perm, int n) {
+    int rank = 0;
+    for (int i = 0; i < n; ++i) {
+        int smaller = 0;
+        for (int j = i + 1; j < n; ++j)
+            if (perm[j] < perm[i]) ++smaller;
+        rank = rank * (n - i) + smaller;
+    }
+    return rank;
+}
+
+void permutationUnrank(int rank, uint8_t *perm, int n) {
+    int digits[12];
+    for (int i = n - 1; i >= 0; --i) {
+        digits[i] = rank % (n - i);
+        rank /= (n - i);
+    }
+    bool used[12] = {false};
+    for (int i = 0; i < n; ++i) {
+        int k = digits[i];
+        for (int v = 0; v < n; ++v) {
+            if (used[v]) continue;
+            if (k-- == 0) {
+                perm[i] = uint8_t(v);
+                used[v] = true;
+                break;
+            }
+        }
+    }
+}
+
+// --------------- orientation ------------------------------------------------
+int twistCoord(const CubeState &s) {
+    int twist = 0;
+    for (int i = 0; i < NUM_CORNERS - 1; ++i) twist = twist * 3 + s.cornerTwist(i);
+    return twist;
+}
+
+void setTwistCoord(CubeState &s, int twist) {
+    int sum = 0;
+    for (int i = NUM_CORNERS - 2; i >= 0; --i) {
+        int t = twist % 3;
+        twist /= 3;
+        sum += t;
+        s.corners[i] = uint8_t(s.cornerCubie(i) | (t << 3));
+    }
+    s.corners[NUM_CORNERS - 1] = uint8_t(s.cornerCubie(NUM_CORNERS - 1) | (((3 - sum % 3) % 3) << 3));
+}
+
+int flipCoord(const CubeState &s) {
+    int flip = 0;
+    for (int i = 0; i < NUM_EDGES - 1; ++i) flip = flip * 2 + s.edgeFlip(i);
+    return flip;
+}
+
+void setFlipCoord(CubeState &s, int flip) {
+    int sum = 0;
+    for (int i = NUM_EDGES - 2; i >= 0; --i) {
+        int f = flip & 1;
+        flip >>= 1;
+        sum += f;
+        s.edges[i] = uint8_t(s.edgeCubie(i) | (f << 4));
+    }
+    s.edges[NUM_EDGES - 1] = uint8_t(s.edgeCubie(NUM_EDGES - 1) | ((sum & 1) << 4));
+}
+
+// --------------- permutation ------------------------------------------------
+int udSliceCoord(const CubeState &s) {
+    int slice = 0, found = 0;
+    for (int j = NUM_EDGES - 1; j >= 0; --j) {
+        if (s.edgeCubie(j) >= FR) {
+            slice += binomial(NUM_EDGES - 1 - j, found + 1);
+            ++found;
+        }
+    }
+    return slice;
+}
+
+void setUDSliceCoord(CubeState &s, int slice) {
+    int left = 4, next_slice = FR, next_other = UR;
+    for (int j = 0; j < NUM_EDGES; ++j) {
+        int c = binomial(NUM_EDGES - 1 - j, left);
+        int cubie;
+        if (left > 0 && slice - c >= 0) {
+            slice -= c;
+            --left;
+            cubie = next_slice++;
+        } else {
+            cubie = next_other++;
+        }
+        s.edges[j] = uint8_t(cubie | (s.edgeFlip(j) << 4));
+    }
+}
+
+int cornerPermCoord(const CubeState &s) {
+    uint8_t perm[NUM_CORNERS];
+    for (int i = 0; i < NUM_CORNERS; ++i) perm[i] = uint8_t(s.cornerCubie(i));
+    return permutationRank(perm, NUM_CORNERS);
+}
+
+void setCornerPermCoord(CubeState &s, int perm) {
+    uint8_t p[NUM_CORNERS];
+    permutationUnrank(perm, p, NUM_CORNERS);
+    for (int i = 0; i < NUM_CORNERS; ++i) s.corners[i] = uint8_t(p[i] | (s.cornerTwist(i) << 3));
+}
+
+int udEdgePermCoord(const CubeState &s) {
+    uint8_t perm[8];
+    for (int i = 0; i < 8; ++i) perm[i] = uint8_t(s.edgeCubie(i));
+    return permutationRank(perm, 8);
+}
+
+void setUDEdgePermCoord(CubeState &s, int perm) {
+    uint8_t p[8];
+    permutationUnrank(perm, p, 8);
+    for (int i = 0; i < 8; ++i) s.edges[i] = uint8_t(p[i] | (s.edgeFlip(i) << 4));
+}
+
+int slicePermCoord(const CubeState &s) {
+    uint8_t perm[4];
+    for (int i = 0; i < 4; ++i) perm[i] = uint8_t(s.edgeCubie(FR + i) - FR);
+    return permutationRank(perm, 4);
+}
+
+void setSlicePermCoord(CubeState &s, int perm) {
+    uint8_t p[4];
+    permutationUnrank(perm, p, 4);
+    for (int i = 0; i < 4; ++i) s.edges[FR + i] = uint8_t((p[i] + FR) | (s.edgeFlip(FR + i) << 4));
+}
+
+// --------------- table builders ---------------------------------------------
+void buildCoordMoveTable(uint16_t *table, int num_coords, const Move *moves, int num_moves,
+                         int (*get)(const CubeState &), void (*set)(CubeState &, int)) {
+    for (int c = 0; c < num_coords; ++c) {
+        CubeState s;
+        set(s, c);
+        for (int m = 0; m < num_moves; ++m) {
+            CubeState t = s;
+            applyMove(t, moves[m]);
+            table[c * num_moves + m] = uint16_t(get(t));
+        }
+    }
+}
+
+void buildPruningTable(uint8_t *table, const uint16_t *move_a, int num_a,
+                       const uint16_t *move_b, int num_b, int num_moves) {
+    buildPruningTable(table, move_a, num_a, move_b, num_b, num_moves, std::vector<uint32_t>(1, 0));
+}
+
+void buildPruningTable(uint8_t *table, const uint16_t *move_a, int num_a,
+                       const uint16_t *move_b, int num_b, int num_moves,
+                       const std::vector<uint32_t> &goals) {
+    size_t size = size_t(num_a) * num_b;
+    memset(table, 0xff, size);
+
+    std::vector<uint32_t> frontier, next;
+    for (size_t i = 0; i < goals.size(); ++i) {
+        if (table[goals[i]] == 0) continue;
+        table[goals[i]] = 0;
+        frontier.push_back(goals[i]);
+    }
+    for (int depth = 0; !frontier.empty(); ++depth) {
+        next.clear();
+        for (size_t i = 0; i < frontier.size(); ++i) {
+            int a = int(frontier[i] / num_b), b = int(frontier[i] % num_b);
+            for (int m = 0; m < num_moves; ++m) {
+                uint32_t index = uint32_t(move_a[a * num_moves + m]) * num_b + move_b[b * num_moves + m];
+                if (table[index] == 0xff) {
+                    table[index] = uint8_t(depth + 1);
+                    next.push_back(index);
+                }
+            }
+        }
+        frontier.swap(next);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef CUBE_COORDS_H
+#define CUBE_COORDS_H
+
+#include "MoveTables.h"
+#include <cstdint>
+#include <vector>
+
+// Coordinates: small integers that each capture one aspect of a CubeState
+// (corner orientation, edge permutation ...). Solvers index their move and
+// pruning tables with them. Every get has a matching set that writes only
+// that aspect, so a table can be built by setting a coordinate on a solved
+// state, applying a move and reading the coordinate back. Solved is 0.
+const int NUM_TWIST = 2187;          // 3^7 corner orientations
+const int NUM_FLIP = 2048;           // 2^11 edge orientations
+const int NUM_UD_SLICE = 495;        // C(12,4) slots holding the FR/FL/BL/BR edges
+const int NUM_CORNER_PERM = 40320;   // 8!
+const int NUM_UD_EDGE_PERM = 40320;  // 8! edges UR..DB, once they stay in the U/D layers
+const int NUM_SLICE_PERM = 24;       // 4! edges FR..BR, once they stay in the middle layer
+
+int twistCoord(const CubeState &s);
+void setTwistCoord(CubeState &s, int twist);
+
+int flipCoord(const CubeState &s);
+void setFlipCoord(CubeState &s, int flip);
+
+int udSliceCoord(const CubeState &s);
+void setUDSliceCoord(CubeState &s, int slice);
+
+int cornerPermCoord(const CubeState &s);
+void setCornerPermCoord(CubeState &s, int perm);
+
+// Only meaningful when slots UR..DB hold edges UR..DB and FR..BR hold FR..BR
+int udEdgePermCoord(const CubeState &s);
+void setUDEdgePermCoord(CubeState &s, int perm);
+int slicePermCoord(const CubeState &s);
+void setSlicePermCoord(CubeState &s, int perm);
+
+// Lehmer code of a permutation of 0..n-1 (identity = 0) and its inverse
+int permutationRank(const uint8_t *perm, int n);
+void permutationUnrank(int rank, uint8_t *perm, int n);
+
+int binomial(int n, int k);
+
+// Coordinate move table: table[coord * num_moves + i] is the coordinate
+// after moves[i]. Get/set are one of the pairs above.
+void buildCoordMoveTable(uint16_t *table, int num_coords, const Move *moves, int num_moves,
+                         int (*get)(const CubeState &), void (*set)(CubeState &, int));
+
+// Distance-to-solved table over the product of two coordinates, indexed
+// a * num_b + b, by breadth-first search from (0, 0). Unreached entries are 0xff.
+void buildPruningTable(uint8_t *table, const uint16_t *move_a, int num_a,
+                       const uint16_t *move_b, int num_b, int num_moves);
+
+// Same, with distances to the nearest of several goal entries
+void buildPruningTable(uint8_t *table, const uint16_t *move_a, int num_a,
+                       const uint16_t *move_b, int num_b, int num_moves,
+                       const std::vector<uint32_t> &goals);
+
+#endif // CUBE_COORDS_H
@@ -0,0 +1,162 @@
+#include "CubeState.h"
+#include "CubeTypes.h"
+#include <cstring>
+
+// Facelets of each corner/edge slot, in the order described in CubeState.h
+const uint8_t CORNER_FACELET[NUM_CORNERS][3] = {
+    {26,  0, 38}, {24, 36, 11}, {18,  9, 47}, {20, 45,  2},
+    {29, 44,  6}, {27, 17, 42}, {33, 53, 15}, {35,  8, 51}
+};
+
+const uint8_t EDGE_FACELET[NUM_EDGES][2] = {
+    {23,  1}, {25, 37}, {21, 10}, {19, 46}, {32,  7}, {28, 43},
+    {30, 16}, {34, 52}, {41,  3}, {39, 14}, {50, 12}, {48,  5}
+};
+
+// Basic quarter turns as cubie permutations/orientations --------------------
+struct TurnDef {
+    uint8_t cp[NUM_CORNERS], co[NUM_CORNERS];
+    uint8_t ep[NUM_EDGES], eo[NUM_EDGES];
+    uint8_t ct[6];
+};
+
+static const TurnDef TURN_DEFS[NUM_QUARTER_TURNS] = {
+    // U
+    {{UBR, URF, UFL, ULB, DFR, DLF, DBL, DRB}, {0, 0, 0, 0, 0, 0, 0, 0},
+     {UB, UR, UF, UL, DR, DF, DL, DB, FR, FL, BL, BR}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+     {0, 1, 2, 3, 4, 5}},
+    // R
+    {{DFR, UFL, ULB, URF, DRB, DLF, DBL, UBR}, {2, 0, 0, 1, 1, 0, 0, 2},
+     {FR, UF, UL, UB, BR, DF, DL, DB, DR, FL, BL, UR}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+     {0, 1, 2, 3, 4, 5}},
+    // F
+    {{UFL, DLF, ULB, UBR, URF, DFR, DBL, DRB}, {1, 2, 0, 0, 2, 1, 0, 0},
+     {UR, FL, UL, UB, DR, FR, DL, DB, UF, DF, BL, BR}, {0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0},
+     {0, 1, 2, 3, 4, 5}},
+    // D
+    {{URF, UFL, ULB, UBR, DLF, DBL, DRB, DFR}, {0, 0, 0, 0, 0, 0, 0, 0},
+     {UR, UF, UL, UB, DF, DL, DB, DR, FR, FL, BL, BR}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+     {0, 1, 2, 3, 4, 5}},
+    // L
+    {{URF, ULB, DBL, UBR, DFR, UFL, DLF, DRB}, {0, 1, 2, 0, 0, 2, 1, 0},
+     {UR, UF, BL, UB, DR, DF, FL, DB, FR, UL, DL, BR}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+     {0, 1, 2, 3, 4, 5}},
+    // B
+    {{URF, UFL, UBR, DRB, DFR, DLF, ULB, DBL}, {0, 0, 1, 2, 0, 0, 2, 1},
+     {UR, UF, UL, BR, DR, DF, DL, BL, FR, FL, UB, DB}, {0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1},
+     {0, 1, 2, 3, 4, 5}},
+    // M
+    {{URF, UFL, ULB, UBR, DFR, DLF, DBL, DRB}, {0, 0, 0, 0, 0, 0, 0, 0},
+     {UR, UB, UL, DB, DR, UF, DL, DF, FR, FL, BL, BR}, {0, 1, 0, 1, 0, 1, 0, 1, 0, 0, 0, 0},
+     {0, 1, 5, 4, 2, 3}},
+    // E
+    {{URF, UFL, ULB, UBR, DFR, DLF, DBL, DRB}, {0, 0, 0, 0, 0, 0, 0, 0},
+     {UR, UF, UL, UB, DR, DF, DL, DB, FL, BL, BR, FR}, {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1},
+     {4, 5, 2, 3, 1, 0}},
+    // S
+    {{URF, UFL, ULB, UBR, DFR, DLF, DBL, DRB}, {0, 0, 0, 0, 0, 0, 0, 0},
+     {UL, UF, DL, UB, UR, DF, DR, DB, FR, FL, BL, BR}, {1, 0, 1, 0, 1, 0, 1, 0, 0, 0, 0, 0},
+     {2, 3, 1, 0, 4, 5}}
+};
+
+// ---------------------------------------------------------------------------
+CubeState::CubeState() {
+    reset();
+}
+
+void CubeState::reset() {
+    for (int i = 0; i < NUM_CORNERS; ++i) corners[i] = uint8_t(i);
+    for (int i = 0; i < NUM_EDGES; ++i) edges[i] = uint8_t(i);
+    for (int i = 0; i < 6; ++i) centers[i] = uint8_t(i);
+}
+
+bool CubeState::isSolved() const {
+    static const CubeState solved;
+    return *this == solved;
+}
+
+bool CubeState::operator==(const CubeState &o) const {
+    return memcmp(corners, o.corners, sizeof(corners)) == 0 &&
+           memcmp(edges, o.edges, sizeof(edges)) == 0 &&
+           memcmp(centers, o.centers, sizeof(centers)) == 0;
+}
+
+void CubeState::multiply(const CubeState &m) {
+    uint8_t c[NUM_CORNERS], e[NUM_EDGES], ct[6];
+
+    for (int i = 0; i < NUM_CORNERS; ++i) {
+        uint8_t from = corners[m.cornerCubie(i)];
+        int twist = (from >> 3) + m.cornerTwist(i);
+        if (twist >= 3) twist -= 3;
+        c[i] = uint8_t((from & 7) | (twist << 3));
+    }
+    for (int i = 0; i < NUM_EDGES; ++i) {
+        uint8_t from = edges[m.edgeCubie(i)];
+        e[i] = uint8_t(from ^ (m.edgeFlip(i) << 4));
+    }
+    for (int i = 0; i < 6; ++i) ct[i] = centers[m.centers[i]];
+
+    memcpy(corners, c, sizeof(c));
+    memcpy(edges, e, sizeof(e));
+    memcpy(centers, ct, sizeof(ct));
+}
+
+CubeState CubeState::inverse() const {
+    CubeState inv;
+    for (int i = 0; i < NUM_CORNERS; ++i) {
+        int twist = cornerTwist(i);
+        inv.corners[cornerCubie(i)] = uint8_t(i | (((3 - twist) % 3) << 3));
+    }
+    for (int i = 0; i < NUM_EDGES; ++i) inv.edges[edgeCubie(i)] = uint8_t(i | (edgeFlip(i) << 4));
+    for (int i = 0; i < 6; ++i) inv.centers[centers[i]] = uint8_t(i);
+    return inv;
+}
+
+void CubeState::applyQuarterTurn(QuarterTurn turn, int times) {
+    const CubeState &m = quarterTurn(turn);
+    for (int i = 0; i < (times & 3); ++i) multiply(m);
+}
+
+// Built once from TURN_DEFS on first use
+struct QuarterTurnStates {
+    CubeState turns[NUM_QUARTER_TURNS];
+
+    QuarterTurnStates() {
+        for (int t = 0; t < NUM_QUARTER_TURNS; ++t) {
+            const TurnDef &d = TURN_DEFS[t];
+            for (int i = 0; i < NUM_CORNERS; ++i) turns[t].corners[i] = uint8_t(d.cp[i] | (d.co[i] << 3));
+            for (int i = 0; i < NUM_EDGES; ++i)   turns[t].edges[i]   = uint8_t(d.ep[i] | (d.eo[i] << 4));
+            for (int i = 0; i < 6; ++i)           turns[t].centers[i] = d.ct[i];
+        }
+    }
+};
+
+const CubeState &CubeState::quarterTurn(QuarterTurn turn) {
+    static const QuarterTurnStates states;
+    return states.turns[turn];
+}
+
+// --------------- facelet view -----------------------------------------------
+void CubeState::getFacelets(uint8_t out[NUM_FACELETS]) const {
+    for (int i = 0; i < NUM_CORNERS; ++i) {
+        int cubie = cornerCubie(i), twist = cornerTwist(i);
+        for (int k = 0; k < 3; ++k)
+            out[CORNER_FACELET[i][(k + twist) % 3]] = CORNER_FACELET[cubie][k] / 9;
+    }
+    for (int i = 0; i < NUM_EDGES; ++i) {
+        int cubie = edgeCubie(i), flip = edgeFlip(i);
+        for (int k = 0; k < 2; ++k)
+            out[EDGE_FACELET[i][(k + flip) & 1]] = EDGE_FACELET[cubie][k] / 9;
+    }
+    for (int f = 0; f < 6; ++f) out[f * 9 + 4] = centers[f];
+}
+
+void CubeState::faceletPosition(int facelet, int &x, int &y, int &z, int &face) {
+    face = facelet / 9;
+    int row = (facelet % 9) / 3 - 1;
+    int col = facelet % 3 - 1;
+    Vec3i p = FACE_NORMAL[face] + FACE_RIGHT[face] * col + FACE_DOWN[face] * row;
+    x = p.x;
+    y = p.y;
+    z = p.z;
+}
@@ -0,0 +1,64 @@
+#ifndef CUBE_STATE_H
+#define CUBE_STATE_H
+
+#include <cstdint>
+
+// Corner and edge slots (also used as cubie names). Each corner is listed
+// by its faces clockwise as seen from outside, starting with the U/D face;
+// edges start with the U/D face, or the F/B face for the middle layer.
+enum Corner { URF, UFL, ULB, UBR, DFR, DLF, DBL, DRB, NUM_CORNERS };
+enum Edge   { UR, UF, UL, UB, DR, DF, DL, DB, FR, FL, BL, BR, NUM_EDGES };
+
+// Standard quarter turns (clockwise as seen from the named face; M follows
+// L, E follows D, S follows F).
+enum QuarterTurn { TURN_U, TURN_R, TURN_F, TURN_D, TURN_L, TURN_B,
+                   TURN_M, TURN_E, TURN_S, NUM_QUARTER_TURNS };
+
+const int NUM_FACELETS = 54;
+
+// Compact cubie-level cube state.
+//
+// Every corner slot holds one byte: the corner cubie in the low 3 bits and
+// its twist (0..2) above them. Every edge slot holds the edge cubie in the
+// low 4 bits and its flip (0..1) above them. Centers are indexed by face
+// (same order as Face in CubeTypes.h) and only move under slice turns.
+//
+// Facelets are numbered face * 9 + row * 3 + col, each face seen from
+// outside with U at the top (B at the top for U, F at the top for D).
+struct CubeState {
+    uint8_t corners[NUM_CORNERS];
+    uint8_t edges[NUM_EDGES];
+    uint8_t centers[6];
+
+    CubeState();  // solved
+
+    int cornerCubie(int slot) const { return corners[slot] & 7; }
+    int cornerTwist(int slot) const { return corners[slot] >> 3; }
+    int edgeCubie(int slot) const { return edges[slot] & 15; }
+    int edgeFlip(int slot) const { return edges[slot] >> 4; }
+
+    void reset();
+    bool isSolved() const;
+
+    // this = this followed by m
+    void multiply(const CubeState &m);
+    CubeState inverse() const;
+    void applyQuarterTurn(QuarterTurn turn, int times = 1);
+
+    // Colour (home face) of every facelet
+    void getFacelets(uint8_t out[NUM_FACELETS]) const;
+
+    bool operator==(const CubeState &o) const;
+    bool operator!=(const CubeState &o) const { return !(*this == o); }
+
+    // The state reached from solved by a single quarter turn
+    static const CubeState &quarterTurn(QuarterTurn turn);
+
+    // Cubie grid position (-1..1) and face of a facelet
+    static void faceletPosition(int facelet, int &x, int &y, int &z, int &face);
+};
+
+extern const uint8_t CORNER_FACELET[NUM_CORNERS][3];
+extern const uint8_t EDGE_FACELET[NUM_EDGES][2];
+
+#endif // CUBE_STATE_H
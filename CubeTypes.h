@@ -0,0 +1,55 @@
+#ifndef CUBE_TYPES_H
+#define CUBE_TYPES_H
+
+// GL-free basics shared by the cube model (librubik) and the renderer
+
+// Face directions
+enum Face {
+    RIGHT = 0,   // +X
+    LEFT = 1,    // -X
+    TOP = 2,     // +Y
+    BOTTOM = 3,  // -Y
+    FRONT = 4,   // +Z
+    BACK = 5     // -Z
+};
+
+// Small integer vector for grid positions and face normals
+template <typename T>
+struct Vec3T {
+    T x, y, z;
+
+    Vec3T(T x = T(0), T y = T(0), T z = T(0)) : x(x), y(y), z(z) {}
+
+    T &operator[](int i) { return i == 0 ? x : (i == 1 ? y : z); }
+    T operator[](int i) const { return i == 0 ? x : (i == 1 ? y : z); }
+
+    Vec3T operator+(const Vec3T &v) const { return Vec3T(x + v.x, y + v.y, z + v.z); }
+    Vec3T operator-(const Vec3T &v) const { return Vec3T(x - v.x, y - v.y, z - v.z); }
+    Vec3T operator-() const { return Vec3T(-x, -y, -z); }
+    Vec3T operator*(T s) const { return Vec3T(x * s, y * s, z * s); }
+    bool operator==(const Vec3T &v) const { return x == v.x && y == v.y && z == v.z; }
+    bool operator!=(const Vec3T &v) const { return !(*this == v); }
+};
+
+typedef Vec3T<int> Vec3i;
+
+// Outward unit normal of each face
+const Vec3i FACE_NORMAL[6] = {
+    Vec3i( 1,  0,  0),  // RIGHT
+    Vec3i(-1,  0,  0),  // LEFT
+    Vec3i( 0,  1,  0),  // TOP
+    Vec3i( 0, -1,  0),  // BOTTOM
+    Vec3i( 0,  0,  1),  // FRONT
+    Vec3i( 0,  0, -1)   // BACK
+};
+
+// "Right" and "down" directions of each face as seen from outside, which
+// order the facelets of a face (U has B at the top, D has F)
+const Vec3i FACE_RIGHT[6] = {
+    Vec3i(0, 0, -1), Vec3i(0, 0, 1), Vec3i(1, 0, 0), Vec3i(1, 0, 0), Vec3i(1, 0, 0), Vec3i(-1, 0, 0)
+};
+const Vec3i FACE_DOWN[6] = {
+    Vec3i(0, -1, 0), Vec3i(0, -1, 0), Vec3i(0, 0, 1), Vec3i(0, 0, -1), Vec3i(0, -1, 0), Vec3i(0, -1, 0)
+};
+
+#endif // CUBE_TYPES_H
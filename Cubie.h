@@ -2,6 +2,7 @@
 #define CUBIE_H
 
 #include "Angel.h"
+#include "CubeTypes.h"
 #include <vector>
 
 typedef vec4 color4;
@@ -16,15 +17,11 @@ const color4 GREEN   = color4(0.0, 1.0, 0.0, 1.0);    // front face (+Z)
 const color4 BLUE    = color4(0.0, 0.0, 1.0, 1.0);    // back face (-Z)
 const color4 BLACK   = color4(0.0, 0.0, 0.0, 1.0);    // for inner faces (not visible)
 
-// Face directions
-enum Face {
-    RIGHT = 0,   // +X
-    LEFT = 1,    // -X
-    TOP = 2,     // +Y
-    BOTTOM = 3,  // -Y
-    FRONT = 4,   // +Z
-    BACK = 5     // -Z
-};
+// Sticker colours are indices into this palette: the home face's colour,
+// in Face order, then black
+const int PALETTE_BLACK = 6;
+const int PALETTE_SIZE = 7;
+const color4 PALETTE[PALETTE_SIZE] = {RED, ORANGE, WHITE, YELLOW, GREEN, BLUE, BLACK};
 
 // Face directions (unit vectors)
 const vec3 FACE_DIR[6] = {
@@ -39,16 +36,14 @@ const vec3 FACE_DIR[6] = {
 // Structure for a cubie (a small cube in the Rubik's cube)
 class Cubie {
 public:
-    int x, y, z;           // Position in 3D grid (-1, 0, 1)
-    color4 colors[6];      // Colors for each face
+    int x, y, z;           // Position in 3D grid (-outer..outer, no 0 on even sizes)
+    int outer;             // Coordinate of the outer layers
+    uint8_t colors[6];     // PALETTE index of each face
     bool visible[6];       // Whether each face is visible
 
-    Cubie(int x = 0, int y = 0, int z = 0);
+    Cubie(int x = 0, int y = 0, int z = 0, int outer = 1);
     void updateVisibility();
     void resetToInitialState();
-    
-    // Get the initial color for a given position and face
-    static color4 getInitialColor(int x, int y, int z, int face);
 };
 
 #endif // CUBIE_H
\ No newline at end of file
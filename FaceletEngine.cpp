@@ -0,0 +1,217 @@
+#include "FaceletEngine.h"
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define FACELET_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__)
+#define FACELET_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Shuffle masks for every move, built once from the cubie move tables.
+//
+// perm:  destination facelet -> source facelet (padding maps to itself)
+// sse:   [move][out register][in register] pshufb masks; lanes whose source
+//        lives in another register are 0x80 so they shuffle in zeros
+// avx:   [move][out ymm][in 128-bit lane], used with each input lane
+//        broadcast to both halves of a ymm register
+struct ShuffleTables {
+    uint8_t perm[NUM_MOVES][64];
+    alignas(16) uint8_t sse[NUM_MOVES][4][4][16];
+    alignas(32) uint8_t avx[NUM_MOVES][2][4][32];
+
+    ShuffleTables() {
+        const MoveTables &t = moveTables();
+
+        for (int m = 0; m < NUM_MOVES; ++m) {
+            uint8_t *p = perm[m];
+            for (int i = 0; i < 64; ++i) p[i] = uint8_t(i);
+
+            for (int i = 0; i < NUM_CORNERS; ++i) {
+                int from = t.cornerSrc[m][i], twist = t.cornerTwist[m][i];
+                for (int k = 0; k < 3; ++k)
+                    p[CORNER_FACELET[i][(k + twist) % 3]] = CORNER_FACELET[from][k];
+            }
+            for (int i = 0; i < NUM_EDGES; ++i) {
+                int from = t.edgeSrc[m][i], flip = t.edgeFlip[m][i] >> 4;
+                for (int k = 0; k < 2; ++k)
+                    p[EDGE_FACELET[i][(k + flip) & 1]] = EDGE_FACELET[from][k];
+            }
+            for (int f = 0; f < 6; ++f) p[f * 9 + 4] = uint8_t(t.centerSrc[m][f] * 9 + 4);
+
+            for (int i = 0; i < 64; ++i) {
+                int out = i >> 4, in = p[i] >> 4;
+                for (int k = 0; k < 4; ++k) {
+                    sse[m][out][k][i & 15] = (k == in) ? uint8_t(p[i] & 15) : 0x80;
+                    avx[m][i >> 5][k][i & 31] = (k == in) ? uint8_t(p[i] & 15) : 0x80;
+                }
+            }
+        }
+    }
+};
+
+static const ShuffleTables &shuffleTables() {
+    static const ShuffleTables tables;
+    return tables;
+}
+
+// --------------- kernels ----------------------------------------------------
+static void applyMovesScalar(FaceletCube &cube, const Move *moves, size_t count) {
+    const ShuffleTables &t = shuffleTables();
+    uint8_t tmp[64];
+    for (size_t n = 0; n < count; ++n) {
+        const uint8_t *p = t.perm[moves[n]];
+        for (int i = 0; i < NUM_FACELETS; ++i) tmp[i] = cube.stickers[p[i]];
+        memcpy(cube.stickers, tmp, NUM_FACELETS);
+    }
+}
+
+#ifdef FACELET_X86
+__attribute__((target("ssse3")))
+static void applyMovesSSSE3(FaceletCube &cube, const Move *moves, size_t count) {
+    const ShuffleTables &t = shuffleTables();
+    __m128i r0 = _mm_loadu_si128((const __m128i *)(cube.stickers + 0));
+    __m128i r1 = _mm_loadu_si128((const __m128i *)(cube.stickers + 16));
+    __m128i r2 = _mm_loadu_si128((const __m128i *)(cube.stickers + 32));
+    __m128i r3 = _mm_loadu_si128((const __m128i *)(cube.stickers + 48));
+
+    for (size_t n = 0; n < count; ++n) {
+        const uint8_t (*mk)[4][16] = t.sse[moves[n]];
+        __m128i o[4];
+        for (int j = 0; j < 4; ++j) {
+            __m128i a = _mm_shuffle_epi8(r0, _mm_load_si128((const __m128i *)mk[j][0]));
+            __m128i b = _mm_shuffle_epi8(r1, _mm_load_si128((const __m128i *)mk[j][1]));
+            __m128i c = _mm_shuffle_epi8(r2, _mm_load_si128((const __m128i *)mk[j][2]));
+            __m128i d = _mm_shuffle_epi8(r3, _mm_load_si128((const __m128i *)mk[j][3]));
+            o[j] = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+        }
+        r0 = o[0]; r1 = o[1]; r2 = o[2]; r3 = o[3];
+    }
+
+    _mm_storeu_si128((__m128i *)(cube.stickers + 0), r0);
+    _mm_storeu_si128((__m128i *)(cube.stickers + 16), r1);
+    _mm_storeu_si128((__m128i *)(cube.stickers + 32), r2);
+    _mm_storeu_si128((__m128i *)(cube.stickers + 48), r3);
+}
+
+__attribute__((target("avx2")))
+static void applyMovesAVX2(FaceletCube &cube, const Move *moves, size_t count) {
+    const ShuffleTables &t = shuffleTables();
+    __m256i lo = _mm256_loadu_si256((const __m256i *)(cube.stickers + 0));
+    __m256i hi = _mm256_loadu_si256((const __m256i *)(cube.stickers + 32));
+
+    for (size_t n = 0; n < count; ++n) {
+        const uint8_t (*mk)[4][32] = t.avx[moves[n]];
+        // vpshufb only shuffles within 128-bit lanes: broadcast each lane
+        __m256i l0 = _mm256_permute2x128_si256(lo, lo, 0x00);
+        __m256i l1 = _mm256_permute2x128_si256(lo, lo, 0x11);
+        __m256i l2 = _mm256_permute2x128_si256(hi, hi, 0x00);
+        __m256i l3 = _mm256_permute2x128_si256(hi, hi, 0x11);
+        __m256i o[2];
+        for (int j = 0; j < 2; ++j) {
+            __m256i a = _mm256_shuffle_epi8(l0, _mm256_load_si256((const __m256i *)mk[j][0]));
+            __m256i b = _mm256_shuffle_epi8(l1, _mm256_load_si256((const __m256i *)mk[j][1]));
+            __m256i c = _mm256_shuffle_epi8(l2, _mm256_load_si256((const __m256i *)mk[j][2]));
+            __m256i d = _mm256_shuffle_epi8(l3, _mm256_load_si256((const __m256i *)mk[j][3]));
+            o[j] = _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d));
+        }
+        lo = o[0]; hi = o[1];
+    }
+
+    _mm256_storeu_si256((__m256i *)(cube.stickers + 0), lo);
+    _mm256_storeu_si256((__m256i *)(cube.stickers + 32), hi);
+}
+#endif
+
+#ifdef FACELET_NEON
+static void applyMovesNEON(FaceletCube &cube, const Move *moves, size_t count) {
+    const ShuffleTables &t = shuffleTables();
+    uint8x16x4_t r = vld1q_u8_x4(cube.stickers);
+
+    for (size_t n = 0; n < count; ++n) {
+        // tbl with four table registers is a full 64-byte permutation
+        const uint8_t *p = t.perm[moves[n]];
+        uint8x16x4_t o;
+        o.val[0] = vqtbl4q_u8(r, vld1q_u8(p + 0));
+        o.val[1] = vqtbl4q_u8(r, vld1q_u8(p + 16));
+        o.val[2] = vqtbl4q_u8(r, vld1q_u8(p + 32));
+        o.val[3] = vqtbl4q_u8(r, vld1q_u8(p + 48));
+        r = o;
+    }
+
+    vst1q_u8_x4(cube.stickers, r);
+}
+#endif
+
+// --------------- dispatch ---------------------------------------------------
+typedef void (*ApplyMovesFn)(FaceletCube &, const Move *, size_t);
+
+struct Kernel {
+    ApplyMovesFn fn;
+    const char *name;
+
+    Kernel() : fn(applyMovesScalar), name("scalar") {
+#if defined(FACELET_NEON)
+        fn = applyMovesNEON; name = "neon";
+#elif defined(FACELET_X86)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))       { fn = applyMovesAVX2;  name = "avx2"; }
+        else if (__builtin_cpu_supports("ssse3")) { fn = applyMovesSSSE3; name = "ssse3"; }
+#endif
+    }
+};
+
+static const Kernel &kernel() {
+    static const Kernel k;
+    return k;
+}
+
+// ---------------------------------------------------------------------------
+FaceletCube::FaceletCube() {
+    for (int i = 0; i < 64; ++i) stickers[i] = uint8_t(i < NUM_FACELETS ? i / 9 : 0);
+}
+
+FaceletCube::FaceletCube(const CubeState &state) {
+    memset(stickers, 0, sizeof(stickers));
+    state.getFacelets(stickers);
+}
+
+bool FaceletCube::operator==(const FaceletCube &o) const {
+    return memcmp(stickers, o.stickers, NUM_FACELETS) == 0;
+}
+
+void FaceletEngine::applyMove(FaceletCube &cube, Move move) {
+    kernel().fn(cube, &move, 1);
+}
+
+void FaceletEngine::applyMoves(FaceletCube &cube, const Move *moves, size_t count) {
+    kernel().fn(cube, moves, count);
+}
+
+const char *FaceletEngine::kernelName() {
+    return kernel().name;
+}
+
+bool FaceletEngine::applyMovesWith(const char *kernel, FaceletCube &cube, const Move *moves, size_t count) {
+    ApplyMovesFn fn = NULL;
+#if defined(FACELET_X86)
+    __builtin_cpu_init();
+#endif
+    if (strcmp(kernel, "scalar") == 0) fn = applyMovesScalar;
+#if defined(FACELET_NEON)
+    else if (strcmp(kernel, "neon") == 0) fn = applyMovesNEON;
+#elif defined(FACELET_X86)
+    else if (strcmp(kernel, "ssse3") == 0 && __builtin_cpu_supports("ssse3")) fn = applyMovesSSSE3;
+    else if (strcmp(kernel, "avx2") == 0 && __builtin_cpu_supports("avx2")) fn = applyMovesAVX2;
+#endif
+    if (!fn) return false;
+    fn(cube, moves, count);
+    return true;
+}
+
+const uint8_t *FaceletEngine::permutation(Move move) {
+    return shuffleTables().perm[move];
+}
@@ -0,0 +1,40 @@
+#ifndef FACELET_ENGINE_H
+#define FACELET_ENGINE_H
+
+#include "MoveTables.h"
+#include <cstddef>
+
+// Sticker-level cube: colour (home face) of each of the 54 facelets, padded
+// to 64 bytes so the whole cube fits in four 16-byte or two 32-byte vector
+// registers. Facelet numbering is the one from CubeState.h. Only 16-byte
+// alignment is asked for, since that is all operator new guarantees before
+// C++17 (a std::vector<FaceletCube>); the kernels load and store unaligned.
+struct FaceletCube {
+    alignas(16) uint8_t stickers[64];
+
+    FaceletCube();                              // solved
+    explicit FaceletCube(const CubeState &state);
+
+    bool operator==(const FaceletCube &o) const;
+    bool operator!=(const FaceletCube &o) const { return !(*this == o); }
+};
+
+// Applies moves as precomputed byte shuffles. The kernel (AVX2, SSSE3,
+// NEON or scalar) is picked once at runtime from the CPU features.
+class FaceletEngine {
+public:
+    static void applyMove(FaceletCube &cube, Move move);
+    static void applyMoves(FaceletCube &cube, const Move *moves, size_t count);
+
+    static const char *kernelName();
+
+    // Runs a named kernel ("scalar", "ssse3", "avx2", "neon") instead of
+    // the picked one, so tests can compare them; false if it is not built
+    // in or the CPU lacks it
+    static bool applyMovesWith(const char *kernel, FaceletCube &cube, const Move *moves, size_t count);
+
+    // Source facelet of every destination facelet for a move
+    static const uint8_t *permutation(Move move);
+};
+
+#endif // FACELET_ENGINE_H
@@ -0,0 +1,271 @@
+#include "Log.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static const size_t LOG_TEXT_SIZE = 240;
+static const size_t LOG_RING_SIZE = 1024;       // records per thread, power of two
+static const int LOG_WRITE_INTERVAL_MS = 10;
+static const int LOG_HOLD_MS = 20;              // records younger than this wait for the next drain
+static const uint32_t LOG_BINARY_VERSION = 1;
+
+struct LogRecord {
+    uint64_t time_ns;
+    uint32_t thread;
+    uint8_t level;
+    uint16_t length;
+    char text[LOG_TEXT_SIZE];
+};
+
+// --------------- per-thread ring --------------------------------------------
+// Single producer (the owning thread), single consumer (whoever holds the
+// logger's drain lock).
+struct LogRing {
+    LogRecord records[LOG_RING_SIZE];
+    std::atomic<size_t> head;
+    char pad[64];
+    std::atomic<size_t> tail;
+    std::atomic<size_t> dropped;
+    std::atomic<bool> retired;      // owning thread has exited
+    uint32_t thread;
+
+    explicit LogRing(uint32_t thread) : head(0), tail(0), dropped(0), retired(false), thread(thread) {}
+
+    LogRecord *reserve() {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == LOG_RING_SIZE) return NULL;
+        return &records[t & (LOG_RING_SIZE - 1)];
+    }
+    void publish() { tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    bool pop(LogRecord &out) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        out = records[h & (LOG_RING_SIZE - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+// --------------- logger -----------------------------------------------------
+namespace {
+
+class Logger {
+public:
+    Logger() : out(stdout), binary(false), running(true), next_thread(0), last_written(0),
+               start(std::chrono::steady_clock::now()) {
+        writer = std::thread(&Logger::run, this);
+    }
+
+    ~Logger() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            running = false;
+        }
+        wake.notify_one();
+        writer.join();
+        drain(true);
+        for (size_t i = 0; i < rings.size(); ++i) delete rings[i];
+        if (out != stdout && out != stderr) fclose(out);
+    }
+
+    LogRing *registerThread() {
+        LogRing *ring = new LogRing(next_thread++);
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        rings.push_back(ring);
+        return ring;
+    }
+
+    uint64_t now() const {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+
+    bool open(const char *path, bool use_binary) {
+        std::lock_guard<std::mutex> lock(drain_mutex);
+        drainLocked(true);
+        FILE *f = stdout;
+        if (path) {
+            f = fopen(path, use_binary ? "wb" : "w");
+            if (!f) return false;
+        }
+        if (out != stdout && out != stderr) fclose(out);
+        out = f;
+        binary = use_binary;
+        if (binary) {
+            fwrite("RLOG", 1, 4, out);
+            fwrite(&LOG_BINARY_VERSION, sizeof(LOG_BINARY_VERSION), 1, out);
+        }
+        return true;
+    }
+
+    void openStderr() {
+        std::lock_guard<std::mutex> lock(drain_mutex);
+        drainLocked(true);
+        if (out != stdout && out != stderr) fclose(out);
+        out = stderr;
+        binary = false;
+    }
+
+    // Writes what is old enough, or everything with 'all'
+    void drain(bool all) {
+        std::lock_guard<std::mutex> lock(drain_mutex);
+        drainLocked(all);
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        while (running) {
+            wake.wait_for(lock, std::chrono::milliseconds(LOG_WRITE_INTERVAL_MS));
+            lock.unlock();
+            drain(false);
+            lock.lock();
+        }
+    }
+
+    static bool earlier(const LogRecord &a, const LogRecord &b) { return a.time_ns < b.time_ns; }
+
+    void drainLocked(bool all) {
+        // Another thread may yet publish a record older than the youngest
+        // ones drained here; those wait for the next drain
+        uint64_t hold = uint64_t(LOG_HOLD_MS) * 1000000, t = now();
+        uint64_t cutoff = all ? UINT64_MAX : (t > hold ? t - hold : 0);
+        size_t old = pending.size();
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex);
+            for (size_t i = 0; i < rings.size();) {
+                LogRing *ring = rings[i];
+                bool retired = ring->retired.load(std::memory_order_acquire);
+                LogRecord record;
+                while (ring->pop(record)) pending.push_back(record);
+
+                size_t dropped = ring->dropped.exchange(0);
+                if (dropped) {
+                    record.time_ns = now();
+                    record.thread = ring->thread;
+                    record.level = LOG_LEVEL_WARN;
+                    record.length = uint16_t(snprintf(record.text, LOG_TEXT_SIZE,
+                                                      "%zu log records dropped (ring full)", dropped));
+                    pending.push_back(record);
+                }
+
+                if (retired) {
+                    delete ring;
+                    rings.erase(rings.begin() + i);
+                } else {
+                    ++i;
+                }
+            }
+        }
+        if (pending.empty()) return;
+
+        // Sort the new records into those held back from earlier drains
+        std::stable_sort(pending.begin() + old, pending.end(), earlier);
+        std::inplace_merge(pending.begin(), pending.begin() + old, pending.end(), earlier);
+        size_t count = 0;
+        for (; count < pending.size() && pending[count].time_ns <= cutoff; ++count) {
+            // Too late to sort in: keep the output in time order
+            LogRecord &r = pending[count];
+            r.time_ns = std::max(r.time_ns, last_written);
+            write(r);
+            last_written = r.time_ns;
+        }
+        if (count == 0) return;
+        pending.erase(pending.begin(), pending.begin() + count);
+        fflush(out);
+    }
+
+    void write(const LogRecord &r) {
+        if (binary) {
+            fwrite(&r.time_ns, sizeof(r.time_ns), 1, out);
+            fwrite(&r.thread, sizeof(r.thread), 1, out);
+            fwrite(&r.level, sizeof(r.level), 1, out);
+            fwrite(&r.length, sizeof(r.length), 1, out);
+            fwrite(r.text, 1, r.length, out);
+        } else {
+            static const char LEVEL_CHAR[] = "TDIWE";
+            fprintf(out, "[%11.6f] %c %.*s\n", r.time_ns * 1e-9, LEVEL_CHAR[r.level],
+                    int(r.length), r.text);
+        }
+    }
+
+    FILE *out;
+    bool binary;
+    bool running;
+    std::atomic<uint32_t> next_thread;
+    std::chrono::steady_clock::time_point start;
+
+    std::mutex rings_mutex;
+    std::vector<LogRing *> rings;
+
+    std::mutex drain_mutex;         // serializes consumers and output changes
+    std::vector<LogRecord> pending; // drained, not yet written; in time order
+    uint64_t last_written;          // time of the newest record written
+
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    std::thread writer;
+};
+
+Logger &logger() {
+    static Logger instance;
+    return instance;
+}
+
+// Marks the thread's ring for collection once the thread exits
+struct ThreadRing {
+    LogRing *ring;
+    ThreadRing() : ring(NULL) {}
+    ~ThreadRing() { if (ring) ring->retired.store(true, std::memory_order_release); }
+};
+
+thread_local ThreadRing thread_ring;
+
+} // namespace
+
+// --------------- API --------------------------------------------------------
+void logWrite(int level, const char *format, ...) {
+    Logger &log = logger();
+    if (!thread_ring.ring) thread_ring.ring = log.registerThread();
+    LogRing *ring = thread_ring.ring;
+
+    LogRecord *r = ring->reserve();
+    if (!r) {
+        ring->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(r->text, LOG_TEXT_SIZE, format, args);
+    va_end(args);
+
+    size_t length = n < 0 ? 0 : std::min(size_t(n), LOG_TEXT_SIZE - 1);
+    while (length > 0 && r->text[length - 1] == '\n') --length;
+    r->time_ns = log.now();
+    r->thread = ring->thread;
+    r->level = uint8_t(level);
+    r->length = uint16_t(length);
+    ring->publish();
+}
+
+bool logOpen(const char *path, bool binary) {
+    return logger().open(path, binary);
+}
+
+void logToStderr() {
+    logger().openStderr();
+}
+
+void logFlush() {
+    logger().drain(true);
+}
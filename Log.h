@@ -0,0 +1,63 @@
+#ifndef LOG_H
+#define LOG_H
+
+// Asynchronous logger.
+//
+// LOG_TRACE .. LOG_ERROR format the message into a per-thread lock-free
+// ring and return; a background thread drains the rings and writes the
+// records in timestamp order. Levels below RUBIK_LOG_LEVEL (set at compile
+// time, INFO by default) compile to nothing and their arguments are never
+// evaluated. A full ring drops records rather than blocking the caller; the
+// writer reports how many were lost.
+//
+// The caller pays for the vsnprintf: what it saves is the locking and the
+// I/O. Records are held back for LOG_HOLD_MS and sorted with everything
+// still pending, so one published a little late by another thread still
+// lands in order; one held up longer than that (a thread preempted between
+// taking its timestamp and publishing) is written as soon as it is seen,
+// stamped with the time of the last record written.
+// logFlush() writes everything pending.
+//
+// Output is text lines on stdout unless logOpen() says otherwise. The
+// binary format is a "RLOG" magic and uint32 version, then per record:
+// uint64 nanoseconds since start, uint32 thread, uint8 level, uint16 length
+// and the message bytes (host byte order). It saves the writer the text
+// framing only; messages are already formatted.
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_WARN  3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_OFF   5
+
+#ifndef RUBIK_LOG_LEVEL
+#define RUBIK_LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#if defined(__GNUC__)
+#define LOG_PRINTF_FORMAT __attribute__((format(printf, 2, 3)))
+#else
+#define LOG_PRINTF_FORMAT
+#endif
+
+void logWrite(int level, const char *format, ...) LOG_PRINTF_FORMAT;
+
+// Redirect output to a file (NULL = stdout). False if it cannot be opened.
+bool logOpen(const char *path, bool binary = false);
+
+// Text output on stderr, leaving stdout to the program's own output
+void logToStderr();
+
+// Write out everything logged so far before returning
+void logFlush();
+
+#define LOG_AT(level, ...) \
+    do { if ((level) >= RUBIK_LOG_LEVEL) logWrite((level), __VA_ARGS__); } while (0)
+
+#define LOG_TRACE(...) LOG_AT(LOG_LEVEL_TRACE, __VA_ARGS__)
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+#endif // LOG_H
@@ -0,0 +1,125 @@
+#ifndef MOVE_QUEUE_H
+#define MOVE_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A queued rotation in startRotation(face, layer, clockwise) terms, packed
+// into 32 bits: face (3 bits), layer + 16 (5 bits), clockwise (1 bit) and
+// 8 bits of flags for the consumer.
+struct MoveRecord {
+    int face;
+    int layer;
+    bool clockwise;
+    uint8_t flags;
+
+    MoveRecord(int face = 0, int layer = 0, bool clockwise = true, uint8_t flags = 0)
+        : face(face), layer(layer), clockwise(clockwise), flags(flags) {}
+
+    uint32_t pack() const {
+        return uint32_t(face & 7) | (uint32_t((layer + 16) & 31) << 3) | (uint32_t(clockwise) << 8) |
+               (uint32_t(flags) << 9);
+    }
+
+    static MoveRecord unpack(uint32_t bits) {
+        return MoveRecord(int(bits & 7), int((bits >> 3) & 31) - 16, ((bits >> 8) & 1) != 0,
+                          uint8_t(bits >> 9));
+    }
+};
+
+// MoveRecord flags
+const uint8_t MOVE_FLAG_TURBO = 1;   // may be applied without animation when the backlog is deep
+
+// Fixed-capacity lock-free ring of packed move records.
+//
+// Any number of threads may push (scripting, solver, network listener...);
+// exactly one thread, the render thread, pops. Each cell carries a sequence
+// number telling producers and the consumer whose turn it is (Vyukov's
+// bounded queue), so neither side ever takes a lock and both are O(1).
+class MoveQueue {
+public:
+    explicit MoveQueue(size_t capacity = 1 << 16)
+        : cells(roundUpPow2(capacity)), mask(cells.size() - 1) {
+        for (size_t i = 0; i < cells.size(); ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    // Any thread. Returns false if the ring is full.
+    bool push(const MoveRecord &record) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = intptr_t(seq) - intptr_t(pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        cell->record = record.pack();
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. Returns false if the ring is empty.
+    bool pop(MoveRecord &record) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        Cell &cell = cells[pos & mask];
+        size_t seq = cell.sequence.load(std::memory_order_acquire);
+        if (intptr_t(seq) - intptr_t(pos + 1) < 0) return false;
+
+        record = MoveRecord::unpack(cell.record);
+        cell.sequence.store(pos + mask + 1, std::memory_order_release);
+        head.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Consumer thread only
+    void clear() {
+        MoveRecord record;
+        while (pop(record)) {}
+    }
+
+    // Approximate while producers are active
+    size_t size() const {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_relaxed);
+        return t > h ? t - h : 0;
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return mask + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        uint32_t record;
+
+        Cell() : sequence(0), record(0) {}
+    };
+
+    static size_t roundUpPow2(size_t n) {
+        size_t size = 2;
+        while (size < n) size <<= 1;
+        return size;
+    }
+
+    std::vector<Cell> cells;
+    size_t mask;
+    // Keep the consumer and producer indices on separate cache lines
+    char pad0[64];
+    std::atomic<size_t> head;
+    char pad1[64];
+    std::atomic<size_t> tail;
+
+    MoveQueue(const MoveQueue &);
+    MoveQueue &operator=(const MoveQueue &);
+};
+
+#endif // MOVE_QUEUE_H
@@ -0,0 +1,216 @@
+#include "MoveSequence.h"
+#include <cctype>
+#include <cstring>
+
+// Axis of each quarter turn (0 = X, 1 = Y, 2 = Z)
+static const int TURN_AXIS[NUM_QUARTER_TURNS] = {
+    1, 0, 2, 1, 0, 2,   // U R F D L B
+    0, 1, 2             // M E S
+};
+
+// Expansion of wide turns and rotations into quarter turns with a power
+// factor (-1 = inverse), e.g. Rw = R M', x = R M' L'
+struct Expansion {
+    QuarterTurn turns[3];
+    int sign[3];
+    int count;
+};
+
+static const Expansion ROTATIONS[3] = {
+    {{TURN_R, TURN_M, TURN_L}, {1, -1, -1}, 3},    // x
+    {{TURN_U, TURN_E, TURN_D}, {1, -1, -1}, 3},    // y
+    {{TURN_F, TURN_S, TURN_B}, {1,  1, -1}, 3}     // z
+};
+
+static bool expansionFor(char c, bool wide, Expansion &e) {
+    static const char *faces = "URFDLB";
+    // Slice that follows each face's wide turn, and its direction
+    static const QuarterTurn wide_slice[6] = {TURN_E, TURN_M, TURN_S, TURN_E, TURN_M, TURN_S};
+    static const int wide_sign[6] = {-1, -1, 1, 1, 1, -1};
+
+    if (c >= 'x' && c <= 'z' && !wide) {
+        e = ROTATIONS[c - 'x'];
+        return true;
+    }
+    const char *f = strchr(faces, toupper(c));
+    if (f && *f && (wide || islower(c))) {
+        int i = int(f - faces);
+        e.turns[0] = QuarterTurn(i);          e.sign[0] = 1;
+        e.turns[1] = wide_slice[i];           e.sign[1] = wide_sign[i];
+        e.count = 2;
+        return true;
+    }
+    return false;
+}
+
+// --------------- parsing ----------------------------------------------------
+namespace {
+
+struct Parser {
+    const std::string &text;
+    size_t pos;
+    int depth;                  // open groups
+    size_t expanded;            // moves appended by group repetition
+    std::string error;
+
+    explicit Parser(const std::string &t) : text(t), pos(0), depth(0), expanded(0) {}
+
+    void skipSpace() {
+        while (pos < text.size() && (isspace((unsigned char)text[pos]) || text[pos] == ','))
+            ++pos;
+    }
+
+    // Optional count and prime: 2, ', 2', 3 ... -> power (may be negative);
+    // false for a count of 0 or above MOVE_MAX_COUNT
+    bool parsePower(int &power) {
+        size_t start = pos;
+        int count = 0;
+        while (pos < text.size() && isdigit((unsigned char)text[pos])) {
+            count = count * 10 + (text[pos++] - '0');
+            if (count > MOVE_MAX_COUNT) {
+                error = "count too large at position " + std::to_string(start + 1);
+                return false;
+            }
+        }
+        if (pos > start && count == 0) {
+            error = "count of 0 at position " + std::to_string(start + 1);
+            return false;
+        }
+        if (pos == start) count = 1;
+        if (pos < text.size() && (text[pos] == '\'' || text[pos] == '`')) {
+            ++pos;
+            count = -count;
+        }
+        power = count;
+        return true;
+    }
+
+    bool parseSequence(MoveSequence &out, bool nested) {
+        for (;;) {
+            skipSpace();
+            if (pos >= text.size()) {
+                if (nested) { error = "missing ')'"; return false; }
+                return true;
+            }
+            char c = text[pos];
+            if (c == ')') {
+                if (!nested) { error = "unexpected ')'"; return false; }
+                ++pos;
+                return true;
+            }
+            if (c == '(') {
+                if (depth == MOVE_MAX_NESTING) {
+                    error = "nesting too deep at position " + std::to_string(pos + 1);
+                    return false;
+                }
+                ++pos;
+                ++depth;
+                MoveSequence group;
+                if (!parseSequence(group, true)) return false;
+                --depth;
+                int power;
+                if (!parsePower(power)) return false;
+                MoveSequence unit = (power < 0) ? group.inverse() : group;
+                for (int i = 0; i < (power < 0 ? -power : power); ++i) {
+                    expanded += unit.size();
+                    if (expanded > MOVE_MAX_EXPANDED) {
+                        error = "groups expand to too many moves";
+                        return false;
+                    }
+                    out.append(unit);
+                }
+                continue;
+            }
+            if (!parseMove(out)) return false;
+        }
+    }
+
+    bool parseMove(MoveSequence &out) {
+        static const char *letters = "URFDLBMES";
+        char c = text[pos];
+        size_t start = pos++;
+        bool wide = (pos < text.size() && text[pos] == 'w');
+        if (wide) ++pos;
+
+        Expansion e = Expansion();
+        int single = -1;
+        const char *l = strchr(letters, c);
+        if (l && *l && !wide) {
+            single = int(l - letters);
+        } else if (!expansionFor(c, wide, e)) {
+            error = "unknown move '" + text.substr(start, pos - start) + "' at position " +
+                    std::to_string(start + 1);
+            return false;
+        }
+
+        int power;
+        if (!parsePower(power)) return false;
+        power %= 4;
+        if (single >= 0) {
+            if (power != 0) out.append(makeMove(QuarterTurn(single), power));
+        } else {
+            for (int i = 0; i < e.count; ++i) {
+                int p = (power * e.sign[i]) % 4;
+                if (p != 0) out.append(makeMove(e.turns[i], p));
+            }
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+bool MoveSequence::parse(const std::string &text, std::string *error) {
+    Parser parser(text);
+    MoveSequence result;
+    if (!parser.parseSequence(result, false)) {
+        if (error) *error = parser.error;
+        return false;
+    }
+    *this = result;
+    return true;
+}
+
+// --------------- compilation ------------------------------------------------
+void MoveSequence::append(Move move) {
+    QuarterTurn turn = moveTurn(move);
+    int axis = TURN_AXIS[turn];
+
+    // Walk back over the trailing run of moves that commute with this one
+    for (size_t i = moves.size(); i-- > 0;) {
+        QuarterTurn t = moveTurn(moves[i]);
+        if (TURN_AXIS[t] != axis) break;
+        if (t == turn) {
+            int power = (movePower(moves[i]) + movePower(move)) & 3;
+            if (power == 0) moves.erase(moves.begin() + i);
+            else moves[i] = makeMove(turn, power);
+            return;
+        }
+    }
+    moves.push_back(move);
+}
+
+void MoveSequence::append(const MoveSequence &other) {
+    for (size_t i = 0; i < other.moves.size(); ++i) append(other.moves[i]);
+}
+
+MoveSequence MoveSequence::inverse() const {
+    MoveSequence inv;
+    for (size_t i = moves.size(); i-- > 0;) inv.moves.push_back(inverseMove(moves[i]));
+    return inv;
+}
+
+CubeState MoveSequence::permutation() const {
+    CubeState state;
+    if (!moves.empty()) applyMoves(state, &moves[0], moves.size());
+    return state;
+}
+
+std::string MoveSequence::toString() const {
+    std::string s;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        if (i) s += ' ';
+        s += moveName(moves[i]);
+    }
+    return s;
+}
@@ -0,0 +1,50 @@
+#ifndef MOVE_SEQUENCE_H
+#define MOVE_SEQUENCE_H
+
+#include "MoveTables.h"
+#include <string>
+#include <vector>
+
+// A compiled move sequence.
+//
+// parse() reads standard notation: face turns R L U D F B, slices M E S,
+// wide turns Rw (or r), whole-cube rotations x y z, each optionally followed
+// by a count and/or ' (R2, U', F2', Rw3), and repeated groups like (R U)3.
+// Wide turns and rotations are expanded into face and slice moves. Text may
+// come from untrusted input, so counts (1 .. MOVE_MAX_COUNT), group nesting
+// and the number of moves groups expand to are bounded.
+//
+// Moves are appended through a cancelling stack: a new move is merged with
+// any move on the same slice inside the trailing run of same-axis moves
+// (those all commute), so R R -> R2, R R' -> nothing, R L R -> R2 L.
+const int MOVE_MAX_COUNT = 99;
+const int MOVE_MAX_NESTING = 64;
+const size_t MOVE_MAX_EXPANDED = size_t(1) << 20;   // moves appended by group repetition
+
+class MoveSequence {
+public:
+    MoveSequence() {}
+
+    bool parse(const std::string &text, std::string *error = NULL);
+
+    void append(Move move);
+    void append(const MoveSequence &other);
+    void clear() { moves.clear(); }
+
+    const std::vector<Move> &getMoves() const { return moves; }
+    size_t size() const { return moves.size(); }
+    bool empty() const { return moves.empty(); }
+
+    MoveSequence inverse() const;
+
+    // The whole sequence as a single permutation: apply it to any state
+    // with state.multiply(permutation()).
+    CubeState permutation() const;
+
+    std::string toString() const;
+
+private:
+    std::vector<Move> moves;
+};
+
+#endif // MOVE_SEQUENCE_H
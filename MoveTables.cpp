@@ -0,0 +1,121 @@
+#include "MoveTables.h"
+#include "CubeTypes.h"
+#include <cstring>
+
+// Standard quarter turn for each (axis, layer + 1), and its sense about the
+// positive axis (+1 = +90 degrees, i.e. counter-clockwise seen from +axis).
+static const QuarterTurn SLICE_TURN[3][3] = {
+    {TURN_L, TURN_M, TURN_R},   // X
+    {TURN_D, TURN_E, TURN_U},   // Y
+    {TURN_B, TURN_S, TURN_F}    // Z
+};
+static const int SLICE_TURN_SENSE[3][3] = {
+    { 1,  1, -1},
+    { 1,  1, -1},
+    { 1, -1, -1}
+};
+
+// ---------------------------------------------------------------------------
+MoveTables::MoveTables() {
+    for (int m = 0; m < NUM_MOVES; ++m) {
+        CubeState s;
+        s.applyQuarterTurn(moveTurn(m), movePower(m));
+
+        for (int i = 0; i < NUM_CORNERS; ++i) {
+            cornerSrc[m][i]   = uint8_t(s.cornerCubie(i));
+            cornerTwist[m][i] = uint8_t(s.cornerTwist(i));
+        }
+        for (int i = 0; i < NUM_EDGES; ++i) {
+            edgeSrc[m][i]  = uint8_t(s.edgeCubie(i));
+            edgeFlip[m][i] = uint8_t(s.edgeFlip(i) << 4);
+        }
+        memcpy(centerSrc[m], s.centers, 6);
+    }
+
+    memset(twistAdd, 0, sizeof(twistAdd));
+    for (int c = 0; c < NUM_CORNERS; ++c)
+        for (int t = 0; t < 3; ++t)
+            for (int d = 0; d < 3; ++d)
+                twistAdd[c | (t << 3)][d] = uint8_t(c | (((t + d) % 3) << 3));
+
+    // startRotation(face, layer, clockwise) turns the slice +90 degrees
+    // (clockwise) or -90 degrees about FACE_DIR[face].
+    memset(moveRotation, 0xff, sizeof(moveRotation));
+    for (int face = 0; face < 6; ++face) {
+        int axis = face / 2;
+        int dir = (face & 1) ? -1 : 1;
+        for (int layer = -1; layer <= 1; ++layer) {
+            for (int cw = 0; cw < 2; ++cw) {
+                int sense = (cw ? 1 : -1) * dir;
+                int power = (sense == SLICE_TURN_SENSE[axis][layer + 1]) ? 1 : 3;
+                Move m = makeMove(SLICE_TURN[axis][layer + 1], power);
+                rotationMove[face][layer + 1][cw] = uint8_t(m);
+                // Prefer the face the move is named after (M/E/S as the keys do)
+                bool natural = (layer == dir) || (layer == 0 && (face == LEFT || face == TOP || face == FRONT));
+                if (moveRotation[m][0] == 0xff || natural) {
+                    moveRotation[m][0] = uint8_t(face);
+                    moveRotation[m][1] = uint8_t(layer + 1);
+                    moveRotation[m][2] = uint8_t(cw);
+                }
+            }
+        }
+    }
+}
+
+const MoveTables &moveTables() {
+    static const MoveTables tables;
+    return tables;
+}
+
+// --------------- application ------------------------------------------------
+// new = old * move, one lookup per slot
+static inline void applyMoveTo(const MoveTables &t, const CubeState &old, CubeState &out, Move move) {
+    const uint8_t *cs = t.cornerSrc[move], *ct = t.cornerTwist[move];
+    const uint8_t *es = t.edgeSrc[move], *ef = t.edgeFlip[move];
+    const uint8_t *zs = t.centerSrc[move];
+
+    for (int i = 0; i < NUM_CORNERS; ++i) out.corners[i] = t.twistAdd[old.corners[cs[i]]][ct[i]];
+    for (int i = 0; i < NUM_EDGES; ++i)   out.edges[i]   = uint8_t(old.edges[es[i]] ^ ef[i]);
+    for (int i = 0; i < 6; ++i)           out.centers[i] = old.centers[zs[i]];
+}
+
+void applyMove(CubeState &state, Move move) {
+    CubeState old = state;
+    applyMoveTo(moveTables(), old, state, move);
+}
+
+void applyMoves(CubeState &state, const Move *moves, size_t count) {
+    const MoveTables &t = moveTables();
+    CubeState buf[2];
+    buf[0] = state;
+    // Ping-pong between two buffers instead of copying after every move
+    for (size_t n = 0; n < count; ++n) applyMoveTo(t, buf[n & 1], buf[(n + 1) & 1], moves[n]);
+    state = buf[count & 1];
+}
+
+void applyMoves(CubeState *states, size_t num_states, const Move *moves, size_t count) {
+    for (size_t i = 0; i < num_states; ++i) applyMoves(states[i], moves, count);
+}
+
+Move moveForRotation(int face, int layer, bool clockwise) {
+    return Move(moveTables().rotationMove[face][layer + 1][clockwise ? 1 : 0]);
+}
+
+int rotationForMove(Move move, int &face, int &layer, bool &clockwise) {
+    // Half turns are two quarter turns of the same rotation
+    Move quarter = (movePower(move) == 2) ? makeMove(moveTurn(move), 1) : move;
+    const uint8_t *r = moveTables().moveRotation[quarter];
+    face = r[0];
+    layer = r[1] - 1;
+    clockwise = r[2] != 0;
+    return movePower(move) == 2 ? 2 : 1;
+}
+
+const char *moveName(int move) {
+    static const char *names[NUM_MOVES] = {
+        "U", "U2", "U'", "R", "R2", "R'", "F", "F2", "F'",
+        "D", "D2", "D'", "L", "L2", "L'", "B", "B2", "B'",
+        "M", "M2", "M'", "E", "E2", "E'", "S", "S2", "S'"
+    };
+    return (move >= 0 && move < NUM_MOVES) ? names[move] : "?";
+}
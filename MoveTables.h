@@ -0,0 +1,56 @@
+#ifndef MOVE_TABLES_H
+#define MOVE_TABLES_H
+
+#include "CubeState.h"
+#include <cstddef>
+
+// All face and slice turns. Each quarter turn X comes as X, X2, X' (X3),
+// so move / 3 is the QuarterTurn and move % 3 + 1 the number of quarter turns.
+enum Move {
+    MOVE_U, MOVE_U2, MOVE_U3, MOVE_R, MOVE_R2, MOVE_R3,
+    MOVE_F, MOVE_F2, MOVE_F3, MOVE_D, MOVE_D2, MOVE_D3,
+    MOVE_L, MOVE_L2, MOVE_L3, MOVE_B, MOVE_B2, MOVE_B3,
+    MOVE_M, MOVE_M2, MOVE_M3, MOVE_E, MOVE_E2, MOVE_E3,
+    MOVE_S, MOVE_S2, MOVE_S3,
+    NUM_MOVES
+};
+
+const int NUM_FACE_MOVES = 18;  // MOVE_U .. MOVE_B3
+
+inline QuarterTurn moveTurn(int move) { return QuarterTurn(move / 3); }
+inline int movePower(int move) { return move % 3 + 1; }
+inline Move makeMove(QuarterTurn turn, int power) { return Move(turn * 3 + (power & 3) - 1); }  // power 1..3 or -1
+inline Move inverseMove(int move) { return Move(move - move % 3 + (2 - move % 3)); }
+
+// Per-move permutation/orientation tables, built once from the basic quarter
+// turns. new slot i takes the cubie of old slot *Src[i] and adds *Twist[i].
+struct MoveTables {
+    uint8_t cornerSrc[NUM_MOVES][NUM_CORNERS];
+    uint8_t cornerTwist[NUM_MOVES][NUM_CORNERS];
+    uint8_t edgeSrc[NUM_MOVES][NUM_EDGES];
+    uint8_t edgeFlip[NUM_MOVES][NUM_EDGES];      // 0 or 16, xor'ed into the edge byte
+    uint8_t centerSrc[NUM_MOVES][6];
+    uint8_t twistAdd[3 << 3][3];                 // packed corner byte + twist
+
+    // Move performed by RubiksCube::startRotation(face, layer, clockwise)
+    uint8_t rotationMove[6][3][2];               // [face][layer + 1][clockwise]
+    uint8_t moveRotation[NUM_MOVES][3];          // one such (face, layer + 1, clockwise) per move
+
+    MoveTables();
+};
+
+const MoveTables &moveTables();
+
+void applyMove(CubeState &state, Move move);
+
+// Batch API: a move stream applied to one state, or the same stream
+// applied to each of num_states states
+void applyMoves(CubeState &state, const Move *moves, size_t count);
+void applyMoves(CubeState *states, size_t num_states, const Move *moves, size_t count);
+
+Move moveForRotation(int face, int layer, bool clockwise);
+// startRotation arguments for a move; returns how many times to apply them
+int rotationForMove(Move move, int &face, int &layer, bool &clockwise);
+const char *moveName(int move);
+
+#endif // MOVE_TABLES_H
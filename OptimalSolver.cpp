@@ -0,0 +1,374 @@
+#include "OptimalSolver.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+static const Move FACE_MOVES[KORF_NUM_MOVES] = {
+    MOVE_U, MOVE_U2, MOVE_U3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_F, MOVE_F2, MOVE_F3,
+    MOVE_D, MOVE_D2, MOVE_D3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_B, MOVE_B2, MOVE_B3
+};
+
+static const int SPLIT_DEPTH = 3;   // tasks are the nodes at this depth
+
+// Number of ways to fill the remaining slots, for the edge index digits
+static const uint32_t EDGE_RADIX[6] = {12, 11, 10, 9, 8, 7};
+
+uint32_t korfEdgeIndex(const uint8_t *edges) {
+    uint32_t index = 0, flips = 0;
+    for (int i = 0; i < 6; ++i) {
+        int slot = edges[i] & 15, smaller = 0;
+        for (int j = 0; j < i; ++j)
+            if ((edges[j] & 15) < slot) ++smaller;
+        index = index * EDGE_RADIX[i] + uint32_t(slot - smaller);
+        flips = (flips << 1) | (edges[i] >> 4);
+    }
+    return (index << 6) | flips;
+}
+
+static void korfEdgeUnindex(uint32_t index, uint8_t *edges) {
+    uint32_t flips = index & 63;
+    index >>= 6;
+    int digits[6];
+    for (int i = 5; i >= 0; --i) {
+        digits[i] = int(index % EDGE_RADIX[i]);
+        index /= EDGE_RADIX[i];
+    }
+    bool used[NUM_EDGES] = {false};
+    for (int i = 0; i < 6; ++i) {
+        int k = digits[i], slot = 0;
+        for (;; ++slot) {
+            if (used[slot]) continue;
+            if (k-- == 0) break;
+        }
+        used[slot] = true;
+        edges[i] = uint8_t(slot | (((flips >> (5 - i)) & 1) << 4));
+    }
+}
+
+// --------------- pattern databases ------------------------------------------
+// Breadth-first search over an index space, one byte per entry. Early
+// levels expand the frontier; once most entries are reached it is cheaper
+// to scan the unreached ones for a neighbour on the last level.
+template <typename Neighbours>
+static void generateDatabase(uint8_t *packed, uint32_t size, uint32_t solved, Neighbours neighbours) {
+    std::vector<uint8_t> dist(size, 0xff);
+    dist[solved] = 0;
+    uint32_t reached = 1;
+    uint32_t next[KORF_NUM_MOVES];
+
+    for (int depth = 0; reached < size; ++depth) {
+        uint32_t added = 0;
+        bool backward = reached > size / 2;
+        for (uint32_t i = 0; i < size; ++i) {
+            if (backward) {
+                if (dist[i] != 0xff) continue;
+                neighbours(i, next);
+                for (int m = 0; m < KORF_NUM_MOVES; ++m) {
+                    if (dist[next[m]] == depth) {
+                        dist[i] = uint8_t(depth + 1);
+                        ++added;
+                        break;
+                    }
+                }
+            } else {
+                if (dist[i] != depth) continue;
+                neighbours(i, next);
+                for (int m = 0; m < KORF_NUM_MOVES; ++m) {
+                    if (dist[next[m]] == 0xff) {
+                        dist[next[m]] = uint8_t(depth + 1);
+                        ++added;
+                    }
+                }
+            }
+        }
+        if (added == 0) break;
+        reached += added;
+    }
+
+    memset(packed, 0, (size + 1) / 2);
+    for (uint32_t i = 0; i < size; ++i) packed[i >> 1] |= uint8_t((dist[i] & 15) << ((i & 1) << 2));
+}
+
+struct CornerNeighbours {
+    const KorfTables *t;
+    void operator()(uint32_t index, uint32_t *out) const {
+        uint32_t perm = index / NUM_TWIST, twist = index % NUM_TWIST;
+        for (int m = 0; m < KORF_NUM_MOVES; ++m)
+            out[m] = uint32_t(t->cornerPermMove[perm * KORF_NUM_MOVES + m]) * NUM_TWIST +
+                     t->twistMove[twist * KORF_NUM_MOVES + m];
+    }
+};
+
+struct EdgeNeighbours {
+    const KorfTables *t;
+    void operator()(uint32_t index, uint32_t *out) const {
+        uint8_t edges[6], moved[6];
+        korfEdgeUnindex(index, edges);
+        for (int m = 0; m < KORF_NUM_MOVES; ++m) {
+            for (int i = 0; i < 6; ++i) moved[i] = t->edgeMove[m][edges[i]];
+            out[m] = korfEdgeIndex(moved);
+        }
+    }
+};
+
+KorfTables::KorfTables() : sections("korf/") {
+    buildCoordMoveTable(cornerPermMove, NUM_CORNER_PERM, FACE_MOVES, KORF_NUM_MOVES,
+                        cornerPermCoord, setCornerPermCoord);
+    buildCoordMoveTable(twistMove, NUM_TWIST, FACE_MOVES, KORF_NUM_MOVES, twistCoord, setTwistCoord);
+
+    const MoveTables &mt = moveTables();
+    memset(edgeMove, 0, sizeof(edgeMove));
+    for (int m = 0; m < KORF_NUM_MOVES; ++m) {
+        for (int dst = 0; dst < NUM_EDGES; ++dst) {
+            int src = mt.edgeSrc[FACE_MOVES[m]][dst];
+            for (int flip = 0; flip < 2; ++flip)
+                edgeMove[m][src | (flip << 4)] = uint8_t(dst | ((flip << 4) ^ mt.edgeFlip[FACE_MOVES[m]][dst]));
+        }
+    }
+
+    static const uint8_t SOLVED_EDGES[NUM_EDGES] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+    static const char *EDGE_DB_NAMES[2] = {"edge_db_0", "edge_db_1"};
+    CornerNeighbours corners = {this};
+    EdgeNeighbours edges = {this};
+
+    // The databases are independent; generate the missing ones side by side
+    std::vector<std::thread> threads;
+    cornerDB = sections.find<uint8_t>("corner_db", KORF_CORNER_SIZE / 2);
+    if (!cornerDB) {
+        uint8_t *db = sections.allocate<uint8_t>("corner_db", KORF_CORNER_SIZE / 2);
+        threads.push_back(std::thread(generateDatabase<CornerNeighbours>, db, KORF_CORNER_SIZE, 0u, corners));
+        cornerDB = db;
+    }
+    for (int i = 0; i < 2; ++i) {
+        edgeDB[i] = sections.find<uint8_t>(EDGE_DB_NAMES[i], KORF_EDGE_SIZE / 2);
+        if (!edgeDB[i]) {
+            uint8_t *db = sections.allocate<uint8_t>(EDGE_DB_NAMES[i], KORF_EDGE_SIZE / 2);
+            threads.push_back(std::thread(generateDatabase<EdgeNeighbours>, db, KORF_EDGE_SIZE,
+                                          korfEdgeIndex(SOLVED_EDGES + 6 * i), edges));
+            edgeDB[i] = db;
+        }
+    }
+    for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+}
+
+const KorfTables &korfTables() {
+    static const KorfTables tables;
+    return tables;
+}
+
+// --------------- search -----------------------------------------------------
+namespace {
+
+struct Node {
+    uint16_t cornerPerm;
+    uint16_t twist;
+    uint8_t edges[NUM_EDGES];   // slot | flip << 4 of each edge cubie
+};
+
+inline Node applyTo(const KorfTables &t, const Node &n, int m) {
+    Node c;
+    c.cornerPerm = t.cornerPermMove[n.cornerPerm * KORF_NUM_MOVES + m];
+    c.twist = t.twistMove[n.twist * KORF_NUM_MOVES + m];
+    for (int i = 0; i < NUM_EDGES; ++i) c.edges[i] = t.edgeMove[m][n.edges[i]];
+    return c;
+}
+
+inline int heuristic(const KorfTables &t, const Node &n) {
+    int h = KorfTables::lookup(t.cornerDB, uint32_t(n.cornerPerm) * NUM_TWIST + n.twist);
+    h = std::max(h, KorfTables::lookup(t.edgeDB[0], korfEdgeIndex(n.edges)));
+    return std::max(h, KorfTables::lookup(t.edgeDB[1], korfEdgeIndex(n.edges + 6)));
+}
+
+// heuristic(n) > budget, stopping at the first database that proves it;
+// every lookup is a likely cache miss
+inline bool exceeds(const KorfTables &t, const Node &n, int budget) {
+    return KorfTables::lookup(t.cornerDB, uint32_t(n.cornerPerm) * NUM_TWIST + n.twist) > budget ||
+           KorfTables::lookup(t.edgeDB[0], korfEdgeIndex(n.edges)) > budget ||
+           KorfTables::lookup(t.edgeDB[1], korfEdgeIndex(n.edges + 6)) > budget;
+}
+
+// Same face twice, or opposite faces in the non-canonical order
+inline bool redundant(int m, int last) {
+    if (last < 0) return false;
+    int face = m / 3, last_face = last / 3;
+    return face == last_face || (face % 3 == last_face % 3 && face < last_face);
+}
+
+struct Task {
+    Node node;
+    int depth;
+    uint8_t path[SPLIT_DEPTH];
+};
+
+struct SharedSearch {
+    const KorfTables &t;
+    std::vector<Task> tasks;
+    std::atomic<size_t> next_task;
+    std::atomic<bool> found;
+    int bound;
+    uint8_t solution[32];
+    int solution_length;
+    std::atomic<int> solution_lock;
+
+    explicit SharedSearch(const KorfTables &tables)
+        : t(tables), next_task(0), found(false), bound(0), solution_length(0), solution_lock(0) {}
+
+    void collectTasks(const Node &n, int depth, int last, uint8_t *path) {
+        if (depth == SPLIT_DEPTH) {
+            Task task;
+            task.node = n;
+            task.depth = depth;
+            memcpy(task.path, path, SPLIT_DEPTH);
+            tasks.push_back(task);
+            return;
+        }
+        for (int m = 0; m < KORF_NUM_MOVES; ++m) {
+            if (redundant(m, last)) continue;
+            Node c = applyTo(t, n, m);
+            if (exceeds(t, c, bound - depth - 1)) continue;
+            path[depth] = uint8_t(m);
+            collectTasks(c, depth + 1, m, path);
+        }
+    }
+
+    void publish(const uint8_t *path, int length) {
+        int expected = 0;
+        if (solution_lock.compare_exchange_strong(expected, 1)) {
+            memcpy(solution, path, length);
+            solution_length = length;
+            found.store(true);
+        }
+    }
+};
+
+struct Worker {
+    SharedSearch &s;
+    uint8_t path[32];
+    unsigned long long nodes;
+
+    explicit Worker(SharedSearch &shared) : s(shared), nodes(0) {}
+
+    // Counts generated nodes, as Korf does
+    bool dfs(const Node &n, int depth, int last) {
+        if (depth == s.bound) {
+            s.publish(path, depth);
+            return true;
+        }
+        for (int m = 0; m < KORF_NUM_MOVES; ++m) {
+            if (redundant(m, last)) continue;
+            Node c = applyTo(s.t, n, m);
+            ++nodes;
+            if (exceeds(s.t, c, s.bound - depth - 1)) continue;
+            path[depth] = uint8_t(m);
+            if (dfs(c, depth + 1, m)) return true;
+            if (s.found.load(std::memory_order_relaxed)) return false;
+        }
+        return false;
+    }
+
+    void run() {
+        for (;;) {
+            if (s.found.load(std::memory_order_relaxed)) return;
+            size_t i = s.next_task.fetch_add(1);
+            if (i >= s.tasks.size()) return;
+            const Task &task = s.tasks[i];
+            memcpy(path, task.path, task.depth);
+            if (dfs(task.node, task.depth, task.path[task.depth - 1])) return;
+        }
+    }
+};
+
+void runWorker(Worker *worker, double *seconds) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    worker->run();
+    *seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+// --------------- solver -----------------------------------------------------
+unsigned long long OptimalSearchStats::totalNodes() const {
+    unsigned long long total = 0;
+    for (size_t i = 0; i < threadNodes.size(); ++i) total += threadNodes[i];
+    return total;
+}
+
+OptimalSolver::OptimalSolver(int threads, int max_length) : num_threads(1), max_length(max_length) {
+    setThreads(threads);
+}
+
+void OptimalSolver::setThreads(int n) {
+    if (n <= 0) n = int(std::thread::hardware_concurrency());
+    num_threads = std::max(n, 1);
+}
+
+bool OptimalSolver::solve(const CubeState &state, MoveSequence &solution, std::string *error) const {
+    return solve(state, solution, error, NULL);
+}
+
+bool OptimalSolver::solve(const CubeState &state, MoveSequence &solution, std::string *error,
+                          OptimalSearchStats *stats) const {
+    if (!checkSolvable(state, error)) return false;
+
+    CubeState s = state;
+    MoveSequence result;
+    orientCenters(s, result);
+
+    const KorfTables &t = korfTables();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    Node root;
+    root.cornerPerm = uint16_t(cornerPermCoord(s));
+    root.twist = uint16_t(twistCoord(s));
+    for (int slot = 0; slot < NUM_EDGES; ++slot)
+        root.edges[s.edgeCubie(slot)] = uint8_t(slot | (s.edgeFlip(slot) << 4));
+
+    std::vector<unsigned long long> thread_nodes(num_threads, 0);
+    std::vector<double> thread_seconds(num_threads, 0.0);
+    SharedSearch shared(t);
+    bool solved = false;
+
+    for (int bound = heuristic(t, root); bound <= max_length && !solved; ++bound) {
+        shared.bound = bound;
+        if (bound <= SPLIT_DEPTH) {
+            // Too shallow to split
+            Worker worker(shared);
+            std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            solved = worker.dfs(root, 0, -1);
+            thread_seconds[0] += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            thread_nodes[0] += worker.nodes;
+            continue;
+        }
+
+        shared.tasks.clear();
+        shared.next_task.store(0);
+        uint8_t prefix[SPLIT_DEPTH];
+        shared.collectTasks(root, 0, -1, prefix);
+
+        std::vector<Worker> workers(num_threads, Worker(shared));
+        std::vector<std::thread> threads;
+        for (int i = 1; i < num_threads; ++i)
+            threads.push_back(std::thread(runWorker, &workers[i], &thread_seconds[i]));
+        runWorker(&workers[0], &thread_seconds[0]);
+        for (size_t i = 0; i < threads.size(); ++i) threads[i].join();
+
+        for (int i = 0; i < num_threads; ++i) thread_nodes[i] += workers[i].nodes;
+        solved = shared.found.load();
+    }
+
+    if (stats) {
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats->threadNodes = thread_nodes;
+        stats->threadSeconds = thread_seconds;
+    }
+    if (!solved) {
+        if (error) *error = "no solution within the move limit";
+        return false;
+    }
+
+    for (int i = 0; i < shared.solution_length; ++i) result.append(FACE_MOVES[shared.solution[i]]);
+    solution = result;
+    return true;
+}
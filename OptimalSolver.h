@@ -0,0 +1,73 @@
+#ifndef OPTIMAL_SOLVER_H
+#define OPTIMAL_SOLVER_H
+
+#include "Solver.h"
+#include "CubeCoords.h"
+#include "TableFile.h"
+#include <vector>
+
+// Korf's optimal solver: IDA* over face turns with the largest of three
+// pattern databases as heuristic.
+//
+//  - corners: all 8! * 3^7 = 88,179,840 corner states
+//  - edges UR..DL and DB..BR: the slots and flips of six edges each,
+//    12!/6! * 2^6 = 42,577,920 entries per database
+//
+// Entries are distances to solved, 4 bits each (about 90 MB in total);
+// generating them by breadth-first search takes a while, so they are
+// normally mapped from the table file written by rubik_tables. The search is split across threads by handing out the
+// nodes at a fixed depth of each iteration as independent tasks.
+const uint32_t KORF_CORNER_SIZE = uint32_t(NUM_CORNER_PERM) * NUM_TWIST;
+const uint32_t KORF_EDGE_SIZE = 665280u * 64u;
+const int KORF_NUM_MOVES = 18;
+
+struct KorfTables {
+    uint16_t cornerPermMove[NUM_CORNER_PERM * KORF_NUM_MOVES];
+    uint16_t twistMove[NUM_TWIST * KORF_NUM_MOVES];
+    uint8_t edgeMove[KORF_NUM_MOVES][32];        // edge slot | flip << 4 after a move
+
+    const uint8_t *cornerDB;                      // two entries per byte
+    const uint8_t *edgeDB[2];
+
+    TableSet sections;                            // databases mapped from the table file or generated
+
+    KorfTables();
+
+    static int lookup(const uint8_t *db, uint32_t index) {
+        return (db[index >> 1] >> ((index & 1) << 2)) & 15;
+    }
+};
+
+const KorfTables &korfTables();
+
+// Index of six edges (slot | flip << 4 of each) in an edge database
+uint32_t korfEdgeIndex(const uint8_t *edges);
+
+struct OptimalSearchStats {
+    double seconds;
+    std::vector<unsigned long long> threadNodes;
+    std::vector<double> threadSeconds;     // time each thread spent searching
+
+    unsigned long long totalNodes() const;
+    double nodesPerSecond() const { return seconds > 0 ? totalNodes() / seconds : 0; }
+};
+
+class OptimalSolver : public Solver {
+public:
+    // threads = 0 uses every hardware thread
+    explicit OptimalSolver(int threads = 0, int max_length = 20);
+
+    const char *name() const { return "optimal"; }
+    bool solve(const CubeState &state, MoveSequence &solution, std::string *error = NULL) const;
+    bool solve(const CubeState &state, MoveSequence &solution, std::string *error,
+               OptimalSearchStats *stats) const;
+
+    void setThreads(int n);
+    int getThreads() const { return num_threads; }
+
+private:
+    int num_threads;
+    int max_length;
+};
+
+#endif // OPTIMAL_SOLVER_H
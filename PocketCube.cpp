@@ -0,0 +1,229 @@
+#include "PocketCube.h"
+#include "CubeCoords.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+static const Move POCKET_MOVES[POCKET_NUM_MOVES] = {
+    MOVE_U, MOVE_U2, MOVE_U3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_F, MOVE_F2, MOVE_F3
+};
+
+// --------------- coordinates ------------------------------------------------
+// Every corner slot but DBL; cubies are numbered the same way, DRB as 6
+static const int POCKET_SLOTS[7] = {URF, UFL, ULB, UBR, DFR, DLF, DRB};
+
+static int pocketPermCoord(const CubeState &s) {
+    uint8_t perm[7];
+    for (int i = 0; i < 7; ++i) {
+        int cubie = s.cornerCubie(POCKET_SLOTS[i]);
+        perm[i] = uint8_t(cubie == DRB ? 6 : cubie);
+    }
+    return permutationRank(perm, 7);
+}
+
+static void setPocketPermCoord(CubeState &s, int perm) {
+    uint8_t p[7];
+    permutationUnrank(perm, p, 7);
+    for (int i = 0; i < 7; ++i) {
+        int slot = POCKET_SLOTS[i];
+        s.corners[slot] = uint8_t(POCKET_SLOTS[p[i]] | (s.cornerTwist(slot) << 3));
+    }
+    s.corners[DBL] = uint8_t(DBL | (s.cornerTwist(DBL) << 3));
+}
+
+// Twists of the first six slots; DRB's follows from them
+static int pocketTwistCoord(const CubeState &s) {
+    int twist = 0;
+    for (int i = 0; i < 6; ++i) twist = twist * 3 + s.cornerTwist(POCKET_SLOTS[i]);
+    return twist;
+}
+
+static void setPocketTwistCoord(CubeState &s, int twist) {
+    int sum = 0;
+    for (int i = 5; i >= 0; --i) {
+        int slot = POCKET_SLOTS[i];
+        s.corners[slot] = uint8_t(s.cornerCubie(slot) | ((twist % 3) << 3));
+        sum += twist % 3;
+        twist /= 3;
+    }
+    s.corners[DRB] = uint8_t(s.cornerCubie(DRB) | (((3 - sum % 3) % 3) << 3));
+    s.corners[DBL] = uint8_t(s.cornerCubie(DBL));
+}
+
+uint32_t pocketIndex(const CubeState &state) {
+    return uint32_t(pocketPermCoord(state)) * POCKET_TWISTS + pocketTwistCoord(state);
+}
+
+// --------------- distance table ---------------------------------------------
+// The search works on 32-bit words of 16 entries so that threads can mark
+// states in the same word at once: an entry only ever goes from 3
+// (unreached) to its distance mod 3, by clearing bits with fetch_and, and
+// whoever sees the 3 in the old value counts the state.
+static uint64_t expandLevel(const PocketTables &t, std::atomic<uint32_t> *words, uint32_t begin, uint32_t end,
+                            int depth) {
+    const uint32_t current = uint32_t(depth % 3), next = uint32_t((depth + 1) % 3);
+    uint64_t found = 0;
+    for (uint32_t w = begin; w < end; ++w) {
+        // Entries equal to current have both bits clear in x
+        uint32_t x = words[w].load(std::memory_order_relaxed) ^ (current * 0x55555555u);
+        uint32_t match = ~(x | (x >> 1)) & 0x55555555u;
+        for (int j = 0; match; ++j, match >>= 2) {
+            if (!(match & 1)) continue;
+            uint32_t index = w * 16 + j;
+            for (int m = 0; m < POCKET_NUM_MOVES; ++m) {
+                uint32_t n = t.move(index, m);
+                std::atomic<uint32_t> &word = words[n >> 4];
+                int shift = int(n & 15) * 2;
+                if (((word.load(std::memory_order_relaxed) >> shift) & 3) != 3) continue;
+                uint32_t old = word.fetch_and(~((3u ^ next) << shift), std::memory_order_relaxed);
+                if (((old >> shift) & 3) == 3) ++found;
+            }
+        }
+    }
+    return found;
+}
+
+std::vector<uint64_t> buildPocketTable(const PocketTables &t, uint8_t *table, int threads) {
+    const uint32_t num_words = POCKET_STATES / 16;
+    std::vector<std::atomic<uint32_t> > words(num_words);
+    for (uint32_t w = 0; w < num_words; ++w) words[w].store(0xffffffffu, std::memory_order_relaxed);
+    words[0].store(0xfffffffcu, std::memory_order_relaxed);  // solved, distance 0
+
+    if (threads < 1) threads = 1;
+    std::vector<uint64_t> counts(1, 1);
+    std::vector<uint64_t> found(threads);
+    for (int depth = 0;; ++depth) {
+        // Level-synchronous: each thread expands the states of this depth
+        // in its own range of words, and all join before the next depth
+        std::vector<std::thread> workers;
+        for (int i = 0; i < threads; ++i) {
+            uint32_t begin = uint32_t(uint64_t(num_words) * i / threads);
+            uint32_t end = uint32_t(uint64_t(num_words) * (i + 1) / threads);
+            workers.push_back(std::thread([&t, &words, &found, begin, end, depth, i] {
+                found[i] = expandLevel(t, words.data(), begin, end, depth);
+            }));
+        }
+        uint64_t total = 0;
+        for (int i = 0; i < threads; ++i) {
+            workers[i].join();
+            total += found[i];
+        }
+        if (total == 0) break;
+        counts.push_back(total);
+    }
+
+    for (uint32_t w = 0; w < num_words; ++w) {
+        uint32_t v = words[w].load(std::memory_order_relaxed);
+        for (int k = 0; k < 4; ++k) table[w * 4 + k] = uint8_t(v >> (k * 8));
+    }
+    return counts;
+}
+
+// --------------- tables -----------------------------------------------------
+PocketTables::PocketTables() : dist(NULL), sections("pocket/") {
+    buildCoordMoveTable(permMove, POCKET_PERMS, POCKET_MOVES, POCKET_NUM_MOVES, pocketPermCoord, setPocketPermCoord);
+    buildCoordMoveTable(twistMove, POCKET_TWISTS, POCKET_MOVES, POCKET_NUM_MOVES, pocketTwistCoord,
+                        setPocketTwistCoord);
+    dist = sections.section<uint8_t>("dist", POCKET_STATES / 4, [this](uint8_t *t) {
+        buildPocketTable(*this, t, std::max(1, int(std::thread::hardware_concurrency())));
+    });
+}
+
+const PocketTables &pocketTables() {
+    static const PocketTables tables;
+    return tables;
+}
+
+// --------------- whole-cube rotations ---------------------------------------
+// The 24 rotations, each with the face move that a U/R/F move becomes when
+// made in the rotated frame
+struct PocketRotations {
+    CubeState rotation[24];
+    Move conjugate[24][POCKET_NUM_MOVES];
+
+    PocketRotations() {
+        MoveSequence x, y;
+        x.parse("x");
+        y.parse("y");
+
+        int count = 1;
+        for (int i = 0; i < count; ++i) {
+            CubeState next[2] = {rotation[i], rotation[i]};
+            next[0].multiply(x.permutation());
+            next[1].multiply(y.permutation());
+            for (int k = 0; k < 2; ++k)
+                if (std::find(rotation, rotation + count, next[k]) == rotation + count) rotation[count++] = next[k];
+        }
+
+        // Rotating, turning and rotating back is a face turn of the cube
+        for (int r = 0; r < 24; ++r) {
+            CubeState back = rotation[r].inverse();
+            for (int m = 0; m < POCKET_NUM_MOVES; ++m) {
+                CubeState c = rotation[r];
+                applyMove(c, POCKET_MOVES[m]);
+                c.multiply(back);
+                for (int f = 0; f < NUM_FACE_MOVES; ++f) {
+                    CubeState face;
+                    applyMove(face, Move(f));
+                    if (memcmp(face.corners, c.corners, sizeof(c.corners)) == 0) conjugate[r][m] = Move(f);
+                }
+            }
+        }
+    }
+};
+
+static const PocketRotations &pocketRotations() {
+    static const PocketRotations rotations;
+    return rotations;
+}
+
+// --------------- solver -----------------------------------------------------
+PocketSolver::PocketSolver() {
+    pocketTables();
+    pocketRotations();
+}
+
+bool PocketSolver::solve(const CubeState &state, MoveSequence &solution, std::string *error) const {
+    int seen = 0, twist = 0;
+    for (int i = 0; i < NUM_CORNERS; ++i) {
+        seen |= 1 << state.cornerCubie(i);
+        twist += state.cornerTwist(i);
+    }
+    if (seen != 0xff || twist % 3 != 0) {
+        if (error) *error = "not a legal 2x2 state";
+        return false;
+    }
+
+    // Rotate the whole cube until DBL is home and untwisted, solve the
+    // U/R/F problem that leaves, and map each move back out of the rotation
+    const PocketRotations &rotations = pocketRotations();
+    int r = 0;
+    CubeState s;
+    for (; r < 24; ++r) {
+        s = state;
+        s.multiply(rotations.rotation[r]);
+        if (s.corners[DBL] == DBL) break;
+    }
+
+    const PocketTables &t = pocketTables();
+    uint32_t index = pocketIndex(s);
+    int d = t.distMod3(index);
+    MoveSequence result;
+    while (index != 0) {
+        int closer = (d + 2) % 3;
+        int m = 0;
+        while (m < POCKET_NUM_MOVES && t.distMod3(t.move(index, m)) != closer) ++m;
+        // Only a damaged table has a state with no neighbour one closer, or
+        // a path longer than God's number
+        if (m == POCKET_NUM_MOVES || int(result.size()) >= POCKET_MAX_DEPTH) {
+            if (error) *error = "distance table inconsistent";
+            return false;
+        }
+        result.append(rotations.conjugate[r][m]);
+        index = t.move(index, m);
+        d = closer;
+    }
+    solution = result;
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef POCKET_CUBE_H
+#define POCKET_CUBE_H
+
+#include "Solver.h"
+#include "TableFile.h"
+#include <vector>
+
+// The 2x2x2 cube: the corners of a CubeState. With no centers to hold it
+// still, the DBL corner is taken as fixed and only U, R and F are turned,
+// which leaves 7! * 3^6 = 3,674,160 states. Every one of them has its
+// distance to solved in a complete table, two bits per state (the
+// distance mod 3: the neighbours of a state at distance d are at d - 1,
+// d or d + 1, all different mod 3), 0.9 MB in all.
+const int POCKET_PERMS = 5040;            // 7! corners other than DBL
+const int POCKET_TWISTS = 729;            // 3^6
+const int POCKET_STATES = POCKET_PERMS * POCKET_TWISTS;
+const int POCKET_NUM_MOVES = 9;           // U, R, F
+const int POCKET_MAX_DEPTH = 11;          // God's number in face turns
+
+struct PocketTables {
+    uint16_t permMove[POCKET_PERMS * POCKET_NUM_MOVES];
+    uint16_t twistMove[POCKET_TWISTS * POCKET_NUM_MOVES];
+    const uint8_t *dist;                  // 4 states per byte, 3 = unreached
+
+    TableSet sections;                    // distance table, mapped or generated
+
+    PocketTables();
+
+    int distMod3(uint32_t index) const { return (dist[index >> 2] >> ((index & 3) << 1)) & 3; }
+    uint32_t move(uint32_t index, int m) const {
+        return uint32_t(permMove[index / POCKET_TWISTS * POCKET_NUM_MOVES + m]) * POCKET_TWISTS +
+               twistMove[index % POCKET_TWISTS * POCKET_NUM_MOVES + m];
+    }
+};
+
+const PocketTables &pocketTables();
+
+// Index of a state with corner DBL home and untwisted
+uint32_t pocketIndex(const CubeState &state);
+
+// Breadth-first search over all states into 'table' (POCKET_STATES / 4
+// bytes) with a level-synchronous sweep split across threads; returns the
+// number of states at each distance
+std::vector<uint64_t> buildPocketTable(const PocketTables &t, uint8_t *table, int threads);
+
+// Optimal 2x2 solutions: the distance table is walked down, one lookup
+// per move. Only the corners of the state are read, and the result is
+// solved up to a rotation of the whole cube.
+class PocketSolver : public Solver {
+public:
+    PocketSolver();
+
+    const char *name() const { return "pocket"; }
+    bool solve(const CubeState &state, MoveSequence &solution, std::string *error = NULL) const;
+};
+
+#endif // POCKET_CUBE_H
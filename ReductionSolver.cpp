@@ -0,0 +1,492 @@
+#include "ReductionSolver.h"
+#include "MoveTables.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+// Sticker permutations: perm[i] is where sticker i goes
+typedef std::vector<uint16_t> StickerPerm;
+
+// Every layer of every axis, named after the nearer face, in all three powers
+std::vector<BigMove> allMoves(int n) {
+    std::vector<BigMove> moves;
+    for (int face = 0; face < 6; ++face) {
+        int layers = (n % 2 == 1 && (face & 1) == 0) ? (n + 1) / 2 : n / 2;
+        for (int depth = 1; depth <= layers; ++depth)
+            for (int turns = 1; turns <= 3; ++turns) {
+                BigMove m = {uint8_t(face), uint8_t(depth), uint8_t(turns)};
+                moves.push_back(m);
+            }
+    }
+    return moves;
+}
+
+BigMove inverse(const BigMove &m) {
+    BigMove inv = {m.face, m.depth, uint8_t(4 - m.turns)};
+    return inv;
+}
+
+// Appends a move, merging it into the last one when they turn the same layer
+void append(std::vector<BigMove> &moves, const BigMove &m) {
+    if (!moves.empty() && moves.back().face == m.face && moves.back().depth == m.depth) {
+        int turns = (moves.back().turns + m.turns) % 4;
+        if (turns == 0) moves.pop_back();
+        else moves.back().turns = uint8_t(turns);
+        return;
+    }
+    moves.push_back(m);
+}
+
+void append(std::vector<BigMove> &moves, const std::vector<BigMove> &more) {
+    for (size_t i = 0; i < more.size(); ++i) append(moves, more[i]);
+}
+
+StickerPerm movePerm(int n, const BigMove &m) {
+    int face, layer;
+    bool clockwise;
+    int times = bigMoveRotation(n, m, face, layer, clockwise);
+    StickerPerm perm(size_t(6) * n * n);
+    for (size_t i = 0; i < perm.size(); ++i) {
+        size_t s = i;
+        for (int t = 0; t < times; ++t) s = BigCube::turnedSticker(n, s, face, layer, clockwise);
+        perm[i] = uint16_t(s);
+    }
+    return perm;
+}
+
+// A 3x3x3 move as the outer or middle layer of an odd or even big cube
+BigMove bigMove(int n, Move move) {
+    int face, layer;
+    bool clockwise;
+    int times = rotationForMove(move, face, layer, clockwise);
+    BigMove m = bigMoveForRotation(n, face, layer * (n / 2), clockwise);
+    if (times == 2) m.turns = 2;
+    return m;
+}
+
+int cycleKey(int a, int b, int c) {
+    if (b < a && b < c) return (b * REDUCTION_SLOTS + c) * REDUCTION_SLOTS + a;
+    if (c < a && c < b) return (c * REDUCTION_SLOTS + a) * REDUCTION_SLOTS + b;
+    return (a * REDUCTION_SLOTS + b) * REDUCTION_SLOTS + c;
+}
+
+enum StickerKind { CORNER_STICKER, MIDGE_STICKER, WING_STICKER, MIDDLE_CENTER, CENTER_STICKER };
+
+StickerKind stickerKind(int n, size_t index) {
+    int row = int(index / n % n), col = int(index % n);
+    bool row_edge = row == 0 || row == n - 1, col_edge = col == 0 || col == n - 1;
+    bool odd = n % 2 == 1;
+    if (row_edge && col_edge) return CORNER_STICKER;
+    if (row_edge || col_edge) return (odd && (row_edge ? col : row) == n / 2) ? MIDGE_STICKER : WING_STICKER;
+    return (odd && row == n / 2 && col == n / 2) ? MIDDLE_CENTER : CENTER_STICKER;
+}
+
+Vec3i stickerCubie(int n, size_t index) {
+    size_t face_size = size_t(n) * n;
+    return BigCube::stickerCubie(n, int(index / face_size), int(index % face_size / n), int(index % n));
+}
+
+} // namespace
+
+// --------------- tables -----------------------------------------------------
+const std::vector<BigMove> *ReductionOrbit::find(int a, int b, int c) const {
+    if (a == b || b == c || a == c) return NULL;
+    int index = cycle[cycleKey(a, b, c)];
+    return index < 0 ? NULL : &algs[index];
+}
+
+ReductionTables::ReductionTables(int n) : n(n) {
+    std::vector<BigMove> moves = allMoves(n);
+    std::vector<StickerPerm> perms;
+    for (size_t m = 0; m < moves.size(); ++m) perms.push_back(movePerm(n, moves[m]));
+    size_t count = size_t(6) * n * n;
+
+    // Orbits of the stickers under the turns
+    std::vector<int> root(count);
+    for (size_t i = 0; i < count; ++i) root[i] = int(i);
+    struct Find {
+        std::vector<int> &root;
+        int operator()(int i) const {
+            while (root[i] != i) i = root[i] = root[root[i]];
+            return i;
+        }
+    } find = {root};
+    for (size_t m = 0; m < perms.size(); ++m)
+        for (size_t i = 0; i < count; ++i) {
+            int a = find(int(i)), b = find(perms[m][i]);
+            if (a != b) root[std::max(a, b)] = std::min(a, b);
+        }
+    std::map<int, std::vector<uint16_t> > members;
+    for (size_t i = 0; i < count; ++i) members[find(int(i))].push_back(uint16_t(i));
+
+    // The other sticker of each wing
+    std::vector<uint16_t> partner(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (stickerKind(n, i) != WING_STICKER) continue;
+        for (size_t j = 0; j < count; ++j)
+            if (j / (size_t(n) * n) != i / (size_t(n) * n) && stickerKind(n, j) == WING_STICKER &&
+                stickerCubie(n, j) == stickerCubie(n, i))
+                partner[i] = uint16_t(j);
+    }
+
+    // Center orbits, and of the two sticker orbits of each wing orbit the
+    // one with the lower first sticker. Each sticker keeps its orbit
+    // (centers first, then wings) and slot.
+    std::vector<int> orbit_of(count, -1), slot_of(count, -1);
+    std::vector<ReductionOrbit *> orbits;
+    for (std::map<int, std::vector<uint16_t> >::const_iterator it = members.begin(); it != members.end(); ++it) {
+        const std::vector<uint16_t> &stickers = it->second;
+        StickerKind kind = stickerKind(n, stickers[0]);
+        if (stickers.size() != size_t(REDUCTION_SLOTS)) continue;
+        if (kind == WING_STICKER && find(partner[stickers[0]]) < it->first) continue;
+        if (kind != WING_STICKER && kind != CENTER_STICKER) continue;
+        ReductionOrbit o;
+        o.wing = kind == WING_STICKER;
+        o.slots = stickers;
+        if (o.wing)
+            for (int s = 0; s < REDUCTION_SLOTS; ++s) o.partner.push_back(partner[stickers[s]]);
+        o.cycle.assign(REDUCTION_SLOTS * REDUCTION_SLOTS * REDUCTION_SLOTS, -1);
+        (o.wing ? wings : centers).push_back(o);
+    }
+    for (size_t k = 0; k < centers.size(); ++k) orbits.push_back(&centers[k]);
+    for (size_t k = 0; k < wings.size(); ++k) orbits.push_back(&wings[k]);
+    for (size_t k = 0; k < orbits.size(); ++k)
+        for (int s = 0; s < REDUCTION_SLOTS; ++s) {
+            orbit_of[orbits[k]->slots[s]] = int(k);
+            slot_of[orbits[k]->slots[s]] = s;
+        }
+
+    // Commutators [a b a', c] that move exactly one orbit's three pieces:
+    // three stickers, or six for wings. By symmetry c can be kept to the
+    // U-D axis, with a off it and b off a's axis.
+    std::vector<std::vector<int> > queue(orbits.size());
+    StickerPerm x(count), x_inv(count), c_inv(count);
+    for (size_t a = 0; a < moves.size(); ++a) {
+        if (moves[a].face / 2 == 1) continue;
+        for (size_t b = 0; b < moves.size(); ++b) {
+            if (moves[b].face / 2 == moves[a].face / 2) continue;
+            const StickerPerm &pa = perms[a], &pb = perms[b];
+            for (size_t i = 0; i < count; ++i) x_inv[pa[i]] = uint16_t(i);   // a' for now
+            for (size_t i = 0; i < count; ++i) x[i] = x_inv[pb[pa[i]]];
+            for (size_t i = 0; i < count; ++i) x_inv[x[i]] = uint16_t(i);
+            for (size_t c = 0; c < moves.size(); ++c) {
+                if (moves[c].face / 2 != 1) continue;
+                const StickerPerm &pc = perms[c];
+
+                // Sticker i stays put when x' c x takes it where c does
+                int moved[6], num_moved = 0;
+                for (size_t i = 0; i < count && num_moved <= 6; ++i)
+                    if (x_inv[pc[x[i]]] != pc[i]) {
+                        if (num_moved < 6) moved[num_moved] = int(i);
+                        ++num_moved;
+                    }
+                if (num_moved != 3 && num_moved != 6) continue;
+
+                // All in one orbit, counting a wing's second sticker as its first's
+                int k = -1, first = -1;
+                bool pure = true;
+                for (int m = 0; m < num_moved; ++m) {
+                    int s = moved[m];
+                    int o = orbit_of[s];
+                    if (o >= 0 && first < 0) first = s;
+                    if (o < 0 && stickerKind(n, s) == WING_STICKER) o = orbit_of[partner[s]];
+                    if (o < 0 || (k >= 0 && o != k)) pure = false;
+                    k = o;
+                }
+                if (!pure || first < 0 || num_moved != (orbits[k]->wing ? 6 : 3)) continue;
+
+                for (size_t i = 0; i < count; ++i) c_inv[pc[i]] = uint16_t(i);
+                int s0 = first, s1 = c_inv[x_inv[pc[x[s0]]]], s2 = c_inv[x_inv[pc[x[s1]]]];
+                int key = cycleKey(slot_of[s0], slot_of[s1], slot_of[s2]);
+                ReductionOrbit &o = *orbits[k];
+                if (o.cycle[key] >= 0) continue;
+                std::vector<BigMove> alg;
+                BigMove seq[8] = {moves[a], moves[b], inverse(moves[a]), moves[c],
+                                  moves[a], inverse(moves[b]), inverse(moves[a]), inverse(moves[c])};
+                for (int m = 0; m < 8; ++m) append(alg, seq[m]);
+                o.cycle[key] = int(o.algs.size());
+                o.algs.push_back(alg);
+                queue[k].push_back(key);
+            }
+        }
+    }
+
+    // Breadth first from the commutators: conjugating by a turn, m' alg m,
+    // cycles the images of the slots under m
+    for (size_t k = 0; k < orbits.size(); ++k) {
+        ReductionOrbit &o = *orbits[k];
+        for (size_t q = 0; q < queue[k].size(); ++q) {
+            int key = queue[k][q];
+            int slot[3] = {key / (REDUCTION_SLOTS * REDUCTION_SLOTS), key / REDUCTION_SLOTS % REDUCTION_SLOTS,
+                           key % REDUCTION_SLOTS};
+            for (size_t m = 0; m < moves.size(); ++m) {
+                int image[3];
+                for (int j = 0; j < 3; ++j) image[j] = slot_of[perms[m][o.slots[slot[j]]]];
+                int next = cycleKey(image[0], image[1], image[2]);
+                if (o.cycle[next] >= 0) continue;
+                std::vector<BigMove> alg(1, inverse(moves[m]));
+                append(alg, o.algs[o.cycle[key]]);
+                append(alg, moves[m]);
+                o.cycle[next] = int(o.algs.size());
+                o.algs.push_back(alg);
+                queue[k].push_back(next);
+            }
+        }
+    }
+}
+
+const ReductionTables &reductionTables(int n) {
+    static std::mutex mutex;
+    static std::map<int, std::unique_ptr<ReductionTables> > tables;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<ReductionTables> &t = tables[n];
+    if (!t) t.reset(new ReductionTables(n));
+    return *t;
+}
+
+// --------------- stages -----------------------------------------------------
+namespace {
+
+const int SLOT_COST = 12;       // moves, about one more three-cycle
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void addStage(std::vector<ReductionStage> *stages, const std::string &name, const std::vector<BigMove> &moves,
+              double seconds) {
+    if (!stages) return;
+    ReductionStage stage = {name, moves, seconds};
+    stages->push_back(stage);
+}
+
+// The piece in a slot: its colour, and a wing's second colour
+int pieceAt(const std::vector<uint8_t> &stickers, const ReductionOrbit &o, int slot) {
+    return stickers[o.slots[slot]] * 6 + (o.wing ? stickers[o.partner[slot]] : 0);
+}
+
+// Fills the slots in order, each with a three-cycle from two later slots,
+// until the orbit matches 'target'. Every cycle in the orbit is in the
+// table, so this only fails if the pieces are not target's pieces or (for
+// wings) are an odd permutation of them.
+bool solveOrbit(BigCube &cube, const ReductionOrbit &o, const BigCube &target, std::vector<BigMove> &moves) {
+    const std::vector<uint8_t> &s = cube.getStickers(), &t = target.getStickers();
+    for (int p = 0; p < REDUCTION_SLOTS; ++p) {
+        int want = pieceAt(t, o, p);
+        if (pieceAt(s, o, p) == want) continue;
+
+        // Prefer cycles that leave the other slots no worse, or also fill
+        // the third slot with the piece moved out of p
+        const std::vector<BigMove> *best = NULL;
+        int best_cost = INT_MAX;
+        for (int a = p + 1; a < REDUCTION_SLOTS; ++a) {
+            if (pieceAt(s, o, a) != want) continue;
+            int cost_a = pieceAt(s, o, a) == pieceAt(t, o, a) ? SLOT_COST : 0;
+            for (int c = p + 1; c < REDUCTION_SLOTS; ++c) {
+                const std::vector<BigMove> *alg = o.find(a, p, c);
+                if (!alg) continue;
+                int cost = int(alg->size()) + cost_a;
+                if (pieceAt(s, o, c) == pieceAt(t, o, c)) cost += SLOT_COST;
+                if (pieceAt(s, o, p) == pieceAt(t, o, c)) cost -= SLOT_COST;
+                if (cost < best_cost) {
+                    best = alg;
+                    best_cost = cost;
+                }
+            }
+        }
+        if (!best) return false;
+        cube.apply(*best);
+        append(moves, *best);
+    }
+    return true;
+}
+
+// Parity of the permutation taking each wing of an orbit to its home slot;
+// -1 if the stickers are not the orbit's wings
+int wingParity(const std::vector<uint8_t> &stickers, int n, const ReductionOrbit &o) {
+    size_t face_size = size_t(n) * n;
+    int home[36];
+    std::fill(home, home + 36, -1);
+    for (int h = 0; h < REDUCTION_SLOTS; ++h) home[o.slots[h] / face_size * 6 + o.partner[h] / face_size] = h;
+    int perm[REDUCTION_SLOTS];
+    int seen = 0;
+    for (int p = 0; p < REDUCTION_SLOTS; ++p) {
+        perm[p] = home[pieceAt(stickers, o, p)];
+        if (perm[p] < 0 || (seen >> perm[p] & 1)) return -1;
+        seen |= 1 << perm[p];
+    }
+    int parity = 0;
+    for (int p = 0; p < REDUCTION_SLOTS; ++p)
+        while (perm[p] != p) {
+            std::swap(perm[p], perm[perm[p]]);
+            parity ^= 1;
+        }
+    return parity;
+}
+
+// The corners, and on odd sizes the middle edges, as a 3x3x3 with its
+// centers home; not checked for solvability
+bool reducedState(const BigCube &cube, CubeState &state, std::string *error) {
+    int n = cube.getSize();
+    int at[3] = {0, n / 2, n - 1};
+    uint8_t f[NUM_FACELETS];
+    for (int i = 0; i < NUM_FACELETS; ++i) f[i] = cube.sticker(i / 9, at[i % 9 / 3], at[i % 3]);
+
+    state.reset();
+    for (int slot = 0; slot < NUM_CORNERS; ++slot) {
+        bool found = false;
+        for (int cubie = 0; cubie < NUM_CORNERS && !found; ++cubie)
+            for (int twist = 0; twist < 3 && !found; ++twist) {
+                found = true;
+                for (int k = 0; k < 3; ++k)
+                    if (f[CORNER_FACELET[slot][(k + twist) % 3]] != CORNER_FACELET[cubie][k] / 9) found = false;
+                if (found) state.corners[slot] = uint8_t(cubie | (twist << 3));
+            }
+        if (!found) {
+            if (error) *error = "unknown corner colours";
+            return false;
+        }
+    }
+    for (int slot = 0; slot < NUM_EDGES && n % 2 == 1; ++slot) {
+        bool found = false;
+        for (int cubie = 0; cubie < NUM_EDGES && !found; ++cubie)
+            for (int flip = 0; flip < 2 && !found; ++flip) {
+                found = f[EDGE_FACELET[slot][flip]] == EDGE_FACELET[cubie][0] / 9 &&
+                        f[EDGE_FACELET[slot][1 - flip]] == EDGE_FACELET[cubie][1] / 9;
+                if (found) state.edges[slot] = uint8_t(cubie | (flip << 4));
+            }
+        if (!found) {
+            if (error) *error = "unknown edge colours";
+            return false;
+        }
+    }
+    return true;
+}
+
+int cornerParity(const CubeState &state) {
+    int parity = 0;
+    for (int i = 0; i < NUM_CORNERS; ++i)
+        for (int j = i + 1; j < NUM_CORNERS; ++j)
+            if (state.cornerCubie(i) > state.cornerCubie(j)) parity ^= 1;
+    return parity;
+}
+
+} // namespace
+
+// --------------- solver -----------------------------------------------------
+ReductionSolver::ReductionSolver() {}
+
+bool ReductionSolver::solve(const BigCube &cube, std::vector<BigMove> &solution, std::string *error,
+                            std::vector<ReductionStage> *stages) const {
+    int n = cube.getSize();
+    if (n < REDUCTION_MIN_SIZE || n > REDUCTION_MAX_SIZE) {
+        if (error) *error = "reduction solves sizes " + std::to_string(REDUCTION_MIN_SIZE) + " to " +
+                            std::to_string(REDUCTION_MAX_SIZE);
+        return false;
+    }
+    const ReductionTables &t = reductionTables(n);
+    if (stages) stages->clear();
+    BigCube c = cube;
+    c.setThreads(1);
+    std::vector<BigMove> result;
+
+    // Parity: a slice quarter turn through each wing orbit in an odd
+    // permutation (a four-cycle of its wings), then U for odd corners
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<BigMove> parity;
+    for (size_t k = 0; k < t.wings.size(); ++k) {
+        int odd = wingParity(c.getStickers(), n, t.wings[k]);
+        if (odd < 0) {
+            if (error) *error = "unknown edge colours";
+            return false;
+        }
+        if (!odd) continue;
+        const ReductionOrbit &o = t.wings[k];
+        Vec3i cubie = BigCube::stickerCubie(n, o.slots[0] / (n * n), o.slots[0] / n % n, o.slots[0] % n);
+        int axis = 0;
+        while (cubie[axis] == n / 2 || cubie[axis] == -(n / 2)) ++axis;
+        BigMove slice = bigMoveForRotation(n, axis * 2, cubie[axis], false);
+        c.apply(slice);
+        append(parity, slice);
+    }
+    if (n % 2 == 0) {
+        CubeState corners;
+        if (!reducedState(c, corners, error)) return false;
+        if (cornerParity(corners)) {
+            BigMove u = {TOP, 1, 1};
+            c.apply(u);
+            append(parity, u);
+        }
+    }
+    addStage(stages, "parity", parity, secondsSince(start));
+    append(result, parity);
+
+    // Centers: on odd sizes first the middle ones, by middle slice turns
+    start = std::chrono::steady_clock::now();
+    std::vector<BigMove> centers;
+    if (n % 2 == 1) {
+        CubeState middle;
+        int seen = 0;
+        for (int f = 0; f < 6; ++f) {
+            middle.centers[f] = c.sticker(f, n / 2, n / 2);
+            seen |= 1 << middle.centers[f];
+        }
+        if (seen != 0x3f) {
+            if (error) *error = "unknown center colours";
+            return false;
+        }
+        MoveSequence turns;
+        orientCenters(middle, turns);
+        for (size_t i = 0; i < turns.size(); ++i) {
+            BigMove m = bigMove(n, turns.getMoves()[i]);
+            c.apply(m);
+            append(centers, m);
+        }
+    }
+    BigCube solved(n);
+    for (size_t k = 0; k < t.centers.size(); ++k)
+        if (!solveOrbit(c, t.centers[k], solved, centers)) {
+            if (error) *error = "unknown center colours";
+            return false;
+        }
+    addStage(stages, "centers", centers, secondsSince(start));
+    append(result, centers);
+
+    // The 3x3x3 solution comes first, as the edges are paired to where it
+    // takes them home from
+    start = std::chrono::steady_clock::now();
+    CubeState reduced;
+    MoveSequence finish_moves;
+    if (!reducedState(c, reduced, error) || !checkSolvable(reduced, error) || !finish.solve(reduced, finish_moves, error)) return false;
+    std::vector<BigMove> last;
+    for (size_t i = 0; i < finish_moves.size(); ++i) append(last, bigMove(n, finish_moves.getMoves()[i]));
+    double last_seconds = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<BigMove> edges;
+    BigCube paired(n);
+    for (size_t i = last.size(); i-- > 0;) paired.apply(inverse(last[i]));
+    for (size_t k = 0; k < t.wings.size(); ++k)
+        if (!solveOrbit(c, t.wings[k], paired, edges)) {
+            if (error) *error = "edges cannot be paired";
+            return false;
+        }
+    addStage(stages, "edges", edges, secondsSince(start));
+    append(result, edges);
+
+    c.apply(last);
+    addStage(stages, "3x3", last, last_seconds);
+    append(result, last);
+
+    if (!c.isSolved()) {
+        if (error) *error = "reduced cube not solved";
+        return false;
+    }
+    solution = result;
+    return true;
+}
@@ -0,0 +1,81 @@
+#ifndef REDUCTION_SOLVER_H
+#define REDUCTION_SOLVER_H
+
+#include "BigCube.h"
+#include "TwoPhaseSolver.h"
+#include <vector>
+
+// The reduction method for the 4x4x4 to 7x7x7: solve the centers, pair the
+// edges and finish as a 3x3x3.
+//
+// Beyond the corners, a big cube is made of orbits of 24 pieces that never
+// leave their orbit: center stickers (each ring of the face centers is one
+// or two orbits) and wing edges (one orbit per pair of inner layers). On
+// odd sizes the middle centers and the middle edges ("midges") behave as
+// on a 3x3x3 and stay with it. For every orbit the tables hold a move
+// sequence for each of the 24 * 23 * 22 / 3 three-cycles of its slots that
+// moves those three pieces and nothing else: a short commutator found by
+// search, carried to every other triple by conjugating with setup turns.
+//
+// The solver then works through each orbit slot by slot, fixing each with
+// the shortest three-cycle that brings the right piece in from a slot not
+// yet done, so every step is one table lookup over at most 24 * 24
+// candidates. Three-cycles are even, so the parities are read off the
+// scramble and fixed first: one inner slice quarter turn for each wing
+// orbit in an odd permutation, and on even sizes one U turn when the
+// corners are (the reduced cube has no edge permutation left to match it).
+// The corners and midges are solved as a 3x3x3 by the two-phase solver;
+// that solution is worked out before the edges, which are paired to
+// wherever it takes them home from, and applied last.
+const int REDUCTION_MIN_SIZE = 4;
+const int REDUCTION_MAX_SIZE = 7;
+const int REDUCTION_SLOTS = 24;     // pieces in every orbit
+
+struct ReductionOrbit {
+    bool wing;
+    std::vector<uint16_t> slots;    // a sticker of each slot, in sticker order
+    std::vector<uint16_t> partner;  // wings: the other sticker of the slot
+
+    // Three-cycle a -> b -> c -> a of slots, with a the smallest, at
+    // [(a * 24 + b) * 24 + c]: index into algs, -1 if not a cycle
+    std::vector<int32_t> cycle;
+    std::vector<std::vector<BigMove> > algs;
+
+    // Moves taking the piece in slot a to b, b to c and c to a; NULL if
+    // the slots are not distinct
+    const std::vector<BigMove> *find(int a, int b, int c) const;
+};
+
+struct ReductionTables {
+    int n;
+    std::vector<ReductionOrbit> centers;
+    std::vector<ReductionOrbit> wings;
+
+    explicit ReductionTables(int n);
+};
+
+// Built on first use for each size, in well under a second
+const ReductionTables &reductionTables(int n);
+
+struct ReductionStage {
+    std::string name;                   // "parity", "centers", "edges", "3x3"
+    std::vector<BigMove> moves;
+    double seconds;
+};
+
+class ReductionSolver {
+public:
+    ReductionSolver();
+
+    // Moves taking the cube to solved, centers home. Sizes
+    // REDUCTION_MIN_SIZE .. REDUCTION_MAX_SIZE; false, with the reason in
+    // *error, for other sizes and for stickers no turns can reach. Also
+    // reports the moves and time of each stage when 'stages' is given.
+    bool solve(const BigCube &cube, std::vector<BigMove> &solution, std::string *error = NULL,
+               std::vector<ReductionStage> *stages = NULL) const;
+
+private:
+    TwoPhaseSolver finish;
+};
+
+#endif // REDUCTION_SOLVER_H
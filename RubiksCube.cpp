@@ -1,80 +1,252 @@
 #include "RubiksCube.h"
-#include <cstdio>
+#include "MoveTables.h"
+#include "Log.h"
 #include <cmath>
 #include <algorithm>
 #include <iostream>
 
-// Generic helpers ------------------------------------------------------------
-static vec3 rotateVec90(const vec3 &v, int axis, bool cw) {
-    // axis: 0->X,1->Y,2->Z. cw means +90° when looking toward +axis.
-    if (axis == 0) {            // X
-        return cw ? vec3(v.x,  v.z, -v.y) : vec3(v.x, -v.z,  v.y);
-    } else if (axis == 1) {     // Y
-        return cw ? vec3(-v.z, v.y,  v.x) : vec3( v.z, v.y, -v.x);
-    }
-    /* axis == 2 */             // Z
-    return cw ? vec3( v.y, -v.x, v.z) : vec3(-v.y,  v.x, v.z);
-}
-
 // ---------------------------------------------------------------------------
 RubiksCube::RubiksCube()
-    : rotating_face(-1), rotating_layer(0), rotation_angle(0.0f), animation_active(false) {
+    : size(3), big(MIN_CUBE_SIZE), cubies_dirty(true), state_version(0), rotating_face(-1), rotating_layer(0),
+      rotation_angle(0.0f), animation_active(false),
+      turbo_threshold(TURBO_THRESHOLD), turbo_tail(TURBO_TAIL) {
     initialize();
 }
 
 RubiksCube::~RubiksCube() = default;
 
 void RubiksCube::initialize() {
+    state.reset();
+    if (size > 3) {
+        if (big.getSize() != size) big = BigCube(size);
+        else big.reset();
+    }
     cubies.clear();
     cubie_transforms.clear();
 
-    for (int x = -1; x <= 1; ++x)
-        for (int y = -1; y <= 1; ++y)
-            for (int z = -1; z <= 1; ++z)
-                cubies.emplace_back(x, y, z);
+    // Only the surface cubies: N^3 - (N-2)^3 of them
+    int outer = outerLayer();
+    for (int i = 0; i < size; ++i)
+        for (int j = 0; j < size; ++j)
+            for (int k = 0; k < size; ++k)
+                if (i == 0 || j == 0 || k == 0 || i == size - 1 || j == size - 1 || k == size - 1)
+                    cubies.emplace_back(BigCube::layerCoord(size, i), BigCube::layerCoord(size, j),
+                                        BigCube::layerCoord(size, k), outer);
 
+    cubies_dirty = true;
+    ++state_version;
+    buildPositionIndex();
     regenerateTransforms();
 }
 
+void RubiksCube::setSize(int n) {
+    if (n < MIN_CUBE_SIZE || n > MAX_CUBE_SIZE) {
+        LOG_WARN("Unsupported cube size %d", n);
+        return;
+    }
+    rotation_queue.clear();
+    animation_active = false;
+    size = n;
+    initialize();
+    LOG_INFO("Switched to %dx%dx%d", n, n, n);
+}
+
+// Cubies keep their grid slot for life (colours follow the state instead),
+// so the lookup table only changes when the cubie vector is rebuilt.
+void RubiksCube::buildPositionIndex() {
+    position_index.assign(size * size * size, -1);
+    for (int i = 0; i < (int)cubies.size(); ++i) {
+        const Cubie &c = cubies[i];
+        position_index[(BigCube::layerIndex(size, c.x) * size + BigCube::layerIndex(size, c.y)) * size +
+                       BigCube::layerIndex(size, c.z)] = i;
+    }
+}
+
+int RubiksCube::cubieAt(int x, int y, int z) const {
+    int i = BigCube::layerIndex(size, x), j = BigCube::layerIndex(size, y), k = BigCube::layerIndex(size, z);
+    if (i < 0 || j < 0 || k < 0 || i >= size || j >= size || k >= size) return -1;
+    if (size % 2 == 0 && (x == 0 || y == 0 || z == 0)) return -1;
+    return position_index[(i * size + j) * size + k];
+}
+
+// --------------- layers -----------------------------------------------------
+int RubiksCube::layerFromFace(int face, int depth) const {
+    depth = std::max(1, std::min(depth, size));
+    int index = (face & 1) ? depth - 1 : size - depth;
+    return BigCube::layerCoord(size, index);
+}
+
+int RubiksCube::layerAt(float coord) const {
+    int index = (int)floorf(coord / getSpacing() + size * 0.5f);
+    return BigCube::layerCoord(size, std::max(0, std::min(index, size - 1)));
+}
+
+float RubiksCube::layerCenter(int layer) const {
+    return (BigCube::layerIndex(size, layer) - (size - 1) * 0.5f) * getSpacing();
+}
+
+const std::vector<Cubie>& RubiksCube::getCubies() const {
+    if (cubies_dirty) syncCubieColors();
+    return cubies;
+}
+
 // --------------- animation --------------------------------------------------
 void RubiksCube::randomize(int moves) {
     rotation_queue.clear();
     static const int faces[6] = {RIGHT, LEFT, TOP, BOTTOM, FRONT, BACK};
-    static const int layers[6] = {1, -1, 1, -1, 1, -1};
     
-    printf("Queueing %d random moves\n", moves);
+    LOG_INFO("Queueing %d random moves", moves);
     
-    // Generate random moves and add to queue - one move at a time
+    // Generate random moves and add to queue - one move at a time; big
+    // cubes also turn inner layers, up to the middle from either side
     for (int i = 0; i < moves; i++) {
         int face_idx = rand() % 6;
         int face = faces[face_idx];
-        int layer = layers[face_idx];
+        int layer = layerFromFace(face, size > 3 ? 1 + rand() % ((size + 1) / 2) : 1);
         bool clockwise = (rand() % 2 == 0);
         
-        // Store face, layer, and whether it's clockwise
-        rotation_queue.emplace_back(std::make_pair(face, layer));
-        rotation_queue_clockwise.push_back(clockwise);
+        if (!enqueueRotation(face, layer, clockwise, true)) {
+            LOG_WARN("Move queue full, dropped %d of %d random moves", moves - i, moves);
+            break;
+        }
         
-        printf("Queued move %d: Face %d, Layer %d, %s\n", 
-               i+1, face, layer, clockwise ? "CW" : "CCW");
+        LOG_DEBUG("Queued move %d: Face %d, Layer %d, %s", 
+                  i+1, face, layer, clockwise ? "CW" : "CCW");
     }
     
     // Start the first rotation if not already animating
-    if (!animation_active && !rotation_queue.empty()) {
-        auto move = rotation_queue.front();
-        bool clockwise = rotation_queue_clockwise.front();
-        rotation_queue.erase(rotation_queue.begin());
-        rotation_queue_clockwise.erase(rotation_queue_clockwise.begin());
-        
-        printf("Starting first move: Face %d, Layer %d, %s\n", 
-               move.first, move.second, clockwise ? "CW" : "CCW");
-        startRotation(move.first, move.second, clockwise);
+    if (!animation_active) startQueuedRotation();
+}
+
+bool RubiksCube::enqueueRotation(int face, int layer, bool clockwise, bool turbo) {
+    // The record has 3 bits of face and 5 of layer: anything else would wrap
+    if (!isValidTurn(face, layer)) return false;
+    return rotation_queue.push(MoveRecord(face, layer, clockwise, turbo ? MOVE_FLAG_TURBO : 0));
+}
+
+// rotationForMove() with the 3x3 layers -1 / 1 moved out to this size's
+// outer layers; the middle layer 0 stays
+int RubiksCube::rotationForSize(Move move, int &face, int &layer, bool &clockwise) const {
+    int times = rotationForMove(move, face, layer, clockwise);
+    layer *= outerLayer();
+    return times;
+}
+
+bool RubiksCube::sequenceFits(const MoveSequence &sequence) const {
+    if (size % 2 != 0) return true;
+    const std::vector<Move> &moves = sequence.getMoves();
+    for (size_t i = 0; i < moves.size(); ++i) {
+        int face, layer;
+        bool clockwise;
+        rotationForMove(moves[i], face, layer, clockwise);
+        if (layer == 0) {
+            LOG_WARN("%s needs a middle layer, which the %dx%dx%d cube does not have", moveName(moves[i]), size,
+                     size, size);
+            return false;
+        }
+    }
+    return true;
+}
+
+void RubiksCube::queueSequence(const MoveSequence &sequence, bool turbo) {
+    if (!sequenceFits(sequence)) return;
+    const std::vector<Move> &moves = sequence.getMoves();
+    for (size_t i = 0; i < moves.size(); ++i) {
+        int face, layer;
+        bool clockwise;
+        int times = rotationForSize(moves[i], face, layer, clockwise);
+        for (int t = 0; t < times; ++t) {
+            if (!enqueueRotation(face, layer, clockwise, turbo)) {
+                LOG_WARN("Move queue full, sequence truncated at move %zu", i + 1);
+                return;
+            }
+        }
+    }
+
+    LOG_INFO("Queued sequence: %s", sequence.toString().c_str());
+}
+
+void RubiksCube::queueBigMoves(const std::vector<BigMove> &moves, bool turbo) {
+    for (size_t i = 0; i < moves.size(); ++i) {
+        int face, layer;
+        bool clockwise;
+        int times = bigMoveRotation(size, moves[i], face, layer, clockwise);
+        for (int t = 0; t < times; ++t) {
+            if (!enqueueRotation(face, layer, clockwise, turbo)) {
+                LOG_WARN("Move queue full, moves truncated at move %zu", i + 1);
+                return;
+            }
+        }
     }
+
+    LOG_INFO("Queued %zu moves", moves.size());
+}
+
+void RubiksCube::applySequence(const MoveSequence &sequence) {
+    if (!sequenceFits(sequence)) return;
+    if (size <= 3) {
+        state.multiply(sequence.permutation());
+    } else {
+        const std::vector<Move> &moves = sequence.getMoves();
+        for (size_t i = 0; i < moves.size(); ++i) {
+            int face, layer;
+            bool clockwise;
+            int times = rotationForSize(moves[i], face, layer, clockwise);
+            for (int t = 0; t < times; ++t) big.turn(face, layer, clockwise);
+        }
+    }
+    cubies_dirty = true;
+    ++state_version;
+}
+
+// Pops the next move to animate. With a deep backlog, turbo moves ahead of
+// the animated tail are applied to the state in one batch on the way.
+// Records checked against an earlier size may no longer fit; they are
+// dropped here or by startRotation.
+bool RubiksCube::popQueuedRotation(MoveRecord &next) {
+    if (!rotation_queue.pop(next)) return false;
+    if (rotation_queue.size() + 1 <= turbo_threshold) return true;
+
+    bool have_next = true;
+    size_t applied = 0;
+    turbo_batch.clear();
+    while ((next.flags & MOVE_FLAG_TURBO) && rotation_queue.size() >= turbo_tail) {
+        if (isValidTurn(next.face, next.layer)) {
+            if (size <= 3) turbo_batch.push_back(moveForRotation(next.face, next.layer, next.clockwise));
+            else big.turn(next.face, next.layer, next.clockwise);
+            ++applied;
+        } else {
+            LOG_WARN("Dropped queued move: face %d, layer %d", next.face, next.layer);
+        }
+        if (!rotation_queue.pop(next)) {
+            have_next = false;
+            break;
+        }
+    }
+
+    if (applied) {
+        if (!turbo_batch.empty()) applyMoves(state, &turbo_batch[0], turbo_batch.size());
+        cubies_dirty = true;
+        ++state_version;
+        LOG_INFO("Turbo: applied %zu queued moves without animation", applied);
+    }
+    return have_next;
+}
+
+bool RubiksCube::startQueuedRotation() {
+    MoveRecord move;
+    if (!popQueuedRotation(move)) return false;
+
+    LOG_DEBUG("Starting next queued move: Face %d, Layer %d, %s", 
+              move.face, move.layer, move.clockwise ? "CW" : "CCW");
+    startRotation(move.face, move.layer, move.clockwise);
+    return true;
 }
 
 // --------------- animation --------------------------------------------------
 void RubiksCube::startRotation(int face, int layer, bool clockwise) {
     if (animation_active) return; // Don't start new rotation if one is already in progress
+    if (!isValidTurn(face, layer)) return;
 
     rotating_face  = face;
     rotating_layer = layer;
@@ -91,124 +263,67 @@ void RubiksCube::startRotation(int face, int layer, bool clockwise) {
 void RubiksCube::updateAnimation() {
     if (!animation_active) {
         // If we have more moves in the queue, start the next one
-        if (!rotation_queue.empty()) {
-            auto move = rotation_queue.front();
-            bool clockwise = rotation_queue_clockwise.front();
-            rotation_queue.erase(rotation_queue.begin());
-            rotation_queue_clockwise.erase(rotation_queue_clockwise.begin());
-            
-            printf("Starting next queued move: Face %d, Layer %d, %s\n", 
-                   move.first, move.second, clockwise ? "CW" : "CCW");
-            startRotation(move.first, move.second, clockwise);
-        }
+        startQueuedRotation();
         return;
     }
 
     rotation_angle += ROTATION_SPEED;
     if (rotation_angle >= 90.0f) {
-        updateCubiesAfterRotation(rotating_face, rotating_layer, rotating_clockwise);
+        applyTurn(rotating_face, rotating_layer, !rotating_clockwise);
         rotation_angle = 0.0f;
         animation_active = false;
         
         // If we have more moves in the queue, start the next one
-        if (!rotation_queue.empty()) {
-            auto move = rotation_queue.front();
-            bool clockwise = rotation_queue_clockwise.front();
-            rotation_queue.erase(rotation_queue.begin());
-            rotation_queue_clockwise.erase(rotation_queue_clockwise.begin());
-            
-            printf("Starting next move in sequence: Face %d, Layer %d, %s\n", 
-                   move.first, move.second, clockwise ? "CW" : "CCW");
-            startRotation(move.first, move.second, clockwise);
-        }
+        startQueuedRotation();
     }
 }
 
 // --------------- core logic -------------------------------------------------
-void RubiksCube::updateCubiesAfterRotation(int face, int layer, bool clockwise) {
-    // Determine principal axis index and cw direction according to our helper
-    int axis = (face == RIGHT || face == LEFT) ? 0 : (face == TOP || face == BOTTOM ? 1 : 2);
-    // For LEFT, BOTTOM, BACK faces the perceived clockwise is opposite
-    bool perceived_clockwise = clockwise;
-    if (face == LEFT || face == BOTTOM || face == BACK) 
-        perceived_clockwise = !perceived_clockwise;
-
-    printf("Updating cubies after rotation: face %d, layer %d, clockwise %d, perceived_clockwise %d\n", 
-           face, layer, clockwise, perceived_clockwise);
-
-    // Gather indices of cubies in the affected slice
-    std::vector<int> slice = getFaceCubies(face, layer);
-    std::vector<Cubie> old = cubies; // snapshot
-
-    // --- Position update ----------------------------------------------------
-    for (int idx : slice) {
-        Cubie &c = cubies[idx];
-        vec3 centre(0);
-        if (axis == 0) centre.x = layer;
-        else if (axis == 1) centre.y = layer;
-        else centre.z = layer;
-
-        vec3 rel = vec3(c.x, c.y, c.z) - centre;
-        vec3 relR = rotateVec90(rel, axis, perceived_clockwise);
-        vec3 posN = relR + centre;
-        c.x = int(round(posN.x));
-        c.y = int(round(posN.y));
-        c.z = int(round(posN.z));
+void RubiksCube::applyTurn(int face, int layer, bool clockwise) {
+    if (size <= 3) {
+        Move move = moveForRotation(face, layer, clockwise);
+        LOG_DEBUG("Updating cubies after rotation: move %s", moveName(move));
+        applyMove(state, move);
+    } else {
+        big.turn(face, layer, clockwise);
     }
+    cubies_dirty = true;
+    ++state_version;
+}
 
-    // --- Sticker colour remap (generic) -------------------------------------
-    for (int idx : slice) {
-        Cubie &dst = cubies[idx];
-        const Cubie &src = old[idx];
-        color4 newColors[6];
-
-        for (int f = 0; f < 6; ++f) {
-            vec3 dirOld = FACE_DIR[f];
-            vec3 dirNew = rotateVec90(dirOld, axis, perceived_clockwise);
-            int toFace = -1;
-            for (int k = 0; k < 6; ++k) {
-                if (dot(dirNew, FACE_DIR[k]) > 0.9f) { 
-                    toFace = k; 
-                    break; 
-                }
-            }
-            if (toFace != -1) {
-                newColors[toFace] = src.colors[f];
-                printf("Color map: face %d -> face %d\n", f, toFace);
-            } else {
-                printf("ERROR: Could not find destination face for direction (%.2f, %.2f, %.2f)\n",
-                       dirNew.x, dirNew.y, dirNew.z);
+// Rebuild sticker colours of the fixed-position cubies from the state (home
+// faces are PALETTE indices); the 2x2 reads the corner facelets of the
+// cubie state
+void RubiksCube::syncCubieColors() const {
+    uint8_t facelets[NUM_FACELETS];
+    if (size <= 3) state.getFacelets(facelets);
+    int step = (size == 2) ? 2 : 1;
+
+    for (int face = 0; face < 6; ++face) {
+        for (int row = 0; row < size; ++row) {
+            for (int col = 0; col < size; ++col) {
+                uint8_t home = (size <= 3) ? facelets[face * 9 + row * step * 3 + col * step]
+                                           : big.sticker(face, row, col);
+                Vec3i p = BigCube::stickerCubie(size, face, row, col);
+                Cubie &c = cubies[cubieAt(p.x, p.y, p.z)];
+                c.colors[face] = home;
             }
         }
-        
-        // Copy the new colors
-        for (int k = 0; k < 6; ++k) 
-            dst.colors[k] = newColors[k];
-
-        dst.updateVisibility();
-        cubie_transforms[idx] = calculateCubieTransform(dst.x, dst.y, dst.z);
     }
+    cubies_dirty = false;
 }
 
 // --------------- utilities --------------------------------------------------
 std::vector<int> RubiksCube::getFaceCubies(int face, int layer) const {
     std::vector<int> res;
-    for (int i = 0; i < cubies.size(); ++i) {
-        const Cubie &c = cubies[i];
-        bool onLayer = false;
-        switch (face) {
-            case RIGHT:  case LEFT:   onLayer = (c.x == layer); break;
-            case TOP:    case BOTTOM: onLayer = (c.y == layer); break;
-            case FRONT:  case BACK:   onLayer = (c.z == layer); break;
-        }
-        if (onLayer) res.push_back(i);
-    }
+    for (int i = 0; i < (int)cubies.size(); ++i)
+        if (cubieLayer(cubies[i], face) == layer) res.push_back(i);
     return res;
 }
 
 mat4 RubiksCube::calculateCubieTransform(int x,int y,int z) const {
-    float s = CUBE_SIZE + CUBE_GAP;
-    return Translate(x*s, y*s, z*s) * Scale(CUBE_SIZE, CUBE_SIZE, CUBE_SIZE);
+    float s = getCubieSize();
+    return Translate(layerCenter(x), layerCenter(y), layerCenter(z)) * Scale(s, s, s);
 }
 
 void RubiksCube::regenerateTransforms() {
@@ -218,5 +333,5 @@ void RubiksCube::regenerateTransforms() {
 
 void RubiksCube::logRotation(int face, int layer, bool cw) const {
     static const char *n[]={"RIGHT","LEFT","TOP","BOTTOM","FRONT","BACK"};
-    printf("Rotate %s layer %d %s\n", n[face], layer, cw?"CW":"CCW");
+    LOG_DEBUG("Rotate %s layer %d %s", n[face], layer, cw?"CW":"CCW");
 }
\ No newline at end of file
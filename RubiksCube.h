@@ -2,12 +2,19 @@
 #define RUBIKS_CUBE_H
 
 #include "Cubie.h"
+#include "CubeState.h"
+#include "BigCube.h"
+#include "MoveTables.h"
+#include "MoveSequence.h"
+#include "MoveQueue.h"
 #include <vector>
 
 // Constants
 const float CUBE_SIZE = 0.28f;
 const float CUBE_GAP = 0.01f;
 const float ROTATION_SPEED = 3.0f;
+const size_t TURBO_THRESHOLD = 64;   // queued moves before turbo mode kicks in
+const size_t TURBO_TAIL = 8;         // moves still animated at the end of a turbo run
 
 class RubiksCube {
 public:
@@ -16,15 +23,64 @@ public:
     
     void initialize();
     void resetCube();
+
+    // Cubies per edge, MIN_CUBE_SIZE..MAX_CUBE_SIZE; resets the cube. Sizes
+    // 2 and 3 keep the cubie state (the 2x2 is its corners) so the solvers
+    // apply; larger cubes are BigCube stickers.
+    void setSize(int size);
+    int getSize() const { return size; }
+
+    // Layers are grid coordinates along a face's axis, -size/2 .. size/2
+    // with no 0 on even sizes; the outer layers are +-size/2
+    int outerLayer() const { return size / 2; }
+    // A face 0..5 and a layer of this size: |layer| <= outerLayer(), no 0
+    // on even sizes
+    bool isValidTurn(int face, int layer) const {
+        return face >= 0 && face < 6 && layer >= -outerLayer() && layer <= outerLayer() &&
+               (layer != 0 || size % 2 != 0);
+    }
+    // The layer 'depth' layers in from a face (1 = the face itself)
+    int layerFromFace(int face, int depth) const;
+    // Layer containing a model-space coordinate, along any axis
+    int layerAt(float coord) const;
+    float layerCenter(int layer) const;
+
+    // Cubies are scaled so that every size fills the same space
+    float getSpacing() const { return (CUBE_SIZE + CUBE_GAP) * 3.0f / size; }
+    float getCubieSize() const { return CUBE_SIZE * 3.0f / size; }
+    float getWidth() const { return size * getSpacing() - CUBE_GAP * 3.0f / size; }
     void randomize(int moves = 20);
+
+    // Queue a rotation for animation. Safe to call from any thread; the
+    // render thread picks it up in updateAnimation(). False if the queue is full
+    // or the face or layer is not one of this size's (see isValidTurn).
+    // Turbo moves may skip their animation when the backlog is deep.
+    bool enqueueRotation(int face, int layer, bool clockwise, bool turbo = false);
+
+    // Turbo mode: once more than 'threshold' moves are queued, turbo moves
+    // are applied straight to the state in one batch and only the last
+    // 'tail' moves are animated.
+    void setTurboPolicy(size_t threshold, size_t tail) { turbo_threshold = threshold; turbo_tail = tail; }
+
+    // Scripted sequences: queued for animation one quarter turn at a time
+    // (any thread), or applied instantly. Face moves turn the outer layers
+    // at any size and M/E/S the middle one; sequences with slice moves are
+    // refused on even sizes, which have no middle layer.
+    void queueSequence(const MoveSequence &sequence, bool turbo = true);
+    void queueBigMoves(const std::vector<BigMove> &moves, bool turbo = true);  // sizes above 3
+    void applySequence(const MoveSequence &sequence);
     
     // Rotation methods
     void startRotation(int face, int layer, bool clockwise);
-    void updateAnimation();
+    void updateAnimation();  // render thread: advances and starts queued moves
     bool isAnimating() const { return animation_active; }
+    bool isIdle() const { return !animation_active && rotation_queue.empty(); }  // nothing animating or queued
     
     // Get methods
-    const std::vector<Cubie>& getCubies() const { return cubies; }
+    const CubeState& getState() const { return state; }          // sizes 2 and 3
+    const BigCube& getBigCube() const { return big; }            // larger sizes
+    unsigned getStateVersion() const { return state_version; }  // bumped on every state change
+    const std::vector<Cubie>& getCubies() const;  // colours derived from state on demand
     const std::vector<mat4>& getTransforms() const { return cubie_transforms; }
     
     // Get current rotation state for rendering
@@ -35,14 +91,22 @@ public:
     bool isRotatingClockwise() const { return rotating_clockwise; }
     
     
+    // Index into getCubies() of the cubie at grid position (x, y, z), -1
+    // inside the cube or outside the grid
+    int cubieAt(int x, int y, int z) const;
+
     // Get cubies on a specific face and layer
     std::vector<int> getFaceCubies(int face, int layer) const;
     
 private:
-    static const int NUM_CUBIES = 27;  // 3x3x3 grid
-    
-    std::vector<Cubie> cubies;
+    int size;
+    CubeState state;                  // source of truth for sizes 2 and 3
+    BigCube big;                      // and for larger cubes
+    mutable std::vector<Cubie> cubies; // render view, one per grid position
+    mutable bool cubies_dirty;
+    unsigned state_version;
     std::vector<mat4> cubie_transforms;
+    std::vector<int> position_index;  // grid position -> index into cubies, -1 inside
     
     // Animation state
     int rotating_face;
@@ -51,12 +115,21 @@ private:
     vec3 rotation_axis;
     bool rotating_clockwise;
     bool animation_active;
-    std::vector<std::pair<int, int>> rotation_queue; // <face, layer>
-    std::vector<bool> rotation_queue_clockwise; // Whether each queued rotation is clockwise
+    MoveQueue rotation_queue;         // many producers, consumed by updateAnimation
+    size_t turbo_threshold;
+    size_t turbo_tail;
+    std::vector<Move> turbo_batch;    // reused between turbo runs
     
     // Helper methods
     void regenerateTransforms();
-    void updateCubiesAfterRotation(int face, int layer, bool clockwise);
+    void buildPositionIndex();
+    bool startQueuedRotation();
+    bool popQueuedRotation(MoveRecord &next);
+    void applyTurn(int face, int layer, bool clockwise);
+    int rotationForSize(Move move, int &face, int &layer, bool &clockwise) const;
+    bool sequenceFits(const MoveSequence &sequence) const;
+    static int cubieLayer(const Cubie &c, int face) { return face < 2 ? c.x : (face < 4 ? c.y : c.z); }
+    void syncCubieColors() const;
     vec3 rotatePosition(const vec3& pos, int face, bool clockwise) const;
     mat4 calculateCubieTransform(int x, int y, int z) const;
     
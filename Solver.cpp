@@ -0,0 +1,108 @@
+#include "Solver.h"
+#include <cstring>
+
+static bool permutationParity(const int *perm, int n) {
+    bool odd = false;
+    for (int i = 0; i < n; ++i)
+        for (int j = i + 1; j < n; ++j)
+            if (perm[j] < perm[i]) odd = !odd;
+    return odd;
+}
+
+static bool centersHome(const CubeState &state) {
+    for (int i = 0; i < 6; ++i)
+        if (state.centers[i] != i) return false;
+    return true;
+}
+
+// Slice moves bringing the centers home, or false if none of up to two do
+static bool findCenterMoves(const CubeState &state, Move moves[2], int &count) {
+    static const Move SLICES[9] = {MOVE_M, MOVE_M2, MOVE_M3, MOVE_E, MOVE_E2, MOVE_E3,
+                                   MOVE_S, MOVE_S2, MOVE_S3};
+    count = 0;
+    if (centersHome(state)) return true;
+    for (int a = 0; a < 9; ++a) {
+        CubeState s = state;
+        applyMove(s, SLICES[a]);
+        if (centersHome(s)) {
+            moves[0] = SLICES[a];
+            count = 1;
+            return true;
+        }
+    }
+    for (int a = 0; a < 9; ++a) {
+        for (int b = 0; b < 9; ++b) {
+            if (moveTurn(SLICES[a]) == moveTurn(SLICES[b])) continue;
+            CubeState s = state;
+            applyMove(s, SLICES[a]);
+            applyMove(s, SLICES[b]);
+            if (centersHome(s)) {
+                moves[0] = SLICES[a];
+                moves[1] = SLICES[b];
+                count = 2;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool checkSolvable(const CubeState &state, std::string *error) {
+    Move moves[2];
+    int count;
+    if (!findCenterMoves(state, moves, count)) {
+        if (error) *error = "centers are not a rotation of the solved cube";
+        return false;
+    }
+    CubeState s = state;
+    for (int i = 0; i < count; ++i) applyMove(s, moves[i]);
+
+    int corners[NUM_CORNERS], edges[NUM_EDGES];
+    bool seen[NUM_EDGES];
+    int twist = 0, flip = 0;
+
+    memset(seen, 0, sizeof(seen));
+    for (int i = 0; i < NUM_CORNERS; ++i) {
+        corners[i] = s.cornerCubie(i);
+        if (s.cornerTwist(i) > 2 || seen[corners[i]]) {
+            if (error) *error = "corners are not a permutation";
+            return false;
+        }
+        seen[corners[i]] = true;
+        twist += s.cornerTwist(i);
+    }
+    memset(seen, 0, sizeof(seen));
+    for (int i = 0; i < NUM_EDGES; ++i) {
+        edges[i] = s.edgeCubie(i);
+        if (edges[i] >= NUM_EDGES || s.edgeFlip(i) > 1 || seen[edges[i]]) {
+            if (error) *error = "edges are not a permutation";
+            return false;
+        }
+        seen[edges[i]] = true;
+        flip += s.edgeFlip(i);
+    }
+
+    if (twist % 3 != 0) {
+        if (error) *error = "a corner is twisted";
+        return false;
+    }
+    if (flip % 2 != 0) {
+        if (error) *error = "an edge is flipped";
+        return false;
+    }
+    if (permutationParity(corners, NUM_CORNERS) != permutationParity(edges, NUM_EDGES)) {
+        if (error) *error = "two pieces are swapped (parity)";
+        return false;
+    }
+    return true;
+}
+
+void orientCenters(CubeState &state, MoveSequence &moves) {
+    Move m[2];
+    int count;
+    if (!findCenterMoves(state, m, count)) return;
+    for (int i = 0; i < count; ++i) {
+        applyMove(state, m[i]);
+        moves.append(m[i]);
+    }
+}
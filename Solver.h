@@ -0,0 +1,32 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include "MoveSequence.h"
+#include <string>
+
+// Common interface of the cube solvers. solve() is const and keeps its
+// search state on the stack, so one solver may be shared between threads;
+// lookup tables are built once and shared read-only.
+class Solver {
+public:
+    virtual ~Solver() {}
+
+    virtual const char *name() const = 0;
+
+    // Moves taking state to solved (centers home). The result can be queued
+    // straight into RubiksCube::queueSequence(). False, with the reason in
+    // *error, if the state cannot be solved.
+    virtual bool solve(const CubeState &state, MoveSequence &solution,
+                       std::string *error = NULL) const = 0;
+};
+
+// False (with the reason) unless the state is a legal cube: corners and
+// edges are permutations, twists and flips sum to zero and, with the
+// centers home, the corner and edge permutation parities agree.
+bool checkSolvable(const CubeState &state, std::string *error = NULL);
+
+// Slice moves that bring every center home (at most two); state is
+// updated to match. Lets face-turn solvers handle states with M/E/S turns.
+void orientCenters(CubeState &state, MoveSequence &moves);
+
+#endif // SOLVER_H
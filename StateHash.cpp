@@ -0,0 +1,48 @@
+#include "StateHash.h"
+#include "Symmetry.h"
+
+struct ZobristKeys {
+    uint64_t corner[NUM_CORNERS][24];
+    uint64_t edge[NUM_EDGES][32];
+    uint64_t center[6][6];
+
+    ZobristKeys() {
+        // splitmix64 with a fixed seed
+        uint64_t seed = 0x52554249434b4559ULL;
+        for (int i = 0; i < NUM_CORNERS; ++i)
+            for (int b = 0; b < 24; ++b) corner[i][b] = next(seed);
+        for (int i = 0; i < NUM_EDGES; ++i)
+            for (int b = 0; b < 32; ++b) edge[i][b] = next(seed);
+        for (int i = 0; i < 6; ++i)
+            for (int b = 0; b < 6; ++b) center[i][b] = next(seed);
+    }
+
+    static uint64_t next(uint64_t &x) {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+};
+
+static const ZobristKeys &zobristKeys() {
+    static const ZobristKeys keys;
+    return keys;
+}
+
+uint64_t hashState(const CubeState &state) {
+    const ZobristKeys &k = zobristKeys();
+    uint64_t h = 0;
+    for (int i = 0; i < NUM_CORNERS; ++i) h ^= k.corner[i][state.corners[i]];
+    for (int i = 0; i < NUM_EDGES; ++i)   h ^= k.edge[i][state.edges[i]];
+    for (int i = 0; i < 6; ++i)           h ^= k.center[i][state.centers[i]];
+    return h;
+}
+
+uint64_t canonicalHash(const CubeState &state, bool use_inverse) {
+    return hashState(canonicalState(state, true, use_inverse));
+}
+
+bool equivalentStates(const CubeState &a, const CubeState &b, bool use_inverse) {
+    return canonicalState(a, true, use_inverse) == canonicalState(b, true, use_inverse);
+}
@@ -0,0 +1,24 @@
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include "CubeState.h"
+#include <cstddef>
+
+// 64-bit Zobrist hash of a state: one fixed random key per (slot, packed
+// byte), XOR'ed together. Keys come from a fixed seed, so hashes are stable
+// across runs and processes and can be stored in on-disk caches.
+uint64_t hashState(const CubeState &state);
+
+// Hash of the canonical state under the 48 symmetries (and inversion), so
+// all equivalent states share one cache/table entry.
+uint64_t canonicalHash(const CubeState &state, bool use_inverse = false);
+
+// True if the states are equal up to a symmetry (and inversion)
+bool equivalentStates(const CubeState &a, const CubeState &b, bool use_inverse = false);
+
+// For std::unordered_set/map keyed by CubeState
+struct CubeStateHasher {
+    size_t operator()(const CubeState &state) const { return size_t(hashState(state)); }
+};
+
+#endif // STATE_HASH_H
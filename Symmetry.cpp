@@ -0,0 +1,179 @@
+#include "Symmetry.h"
+#include "CubeTypes.h"
+#include <cstring>
+
+// --------------- table generation -------------------------------------------
+static Vec3i transform(const int8_t m[3][3], const Vec3i &v) {
+    return Vec3i(m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+                 m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+                 m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z);
+}
+
+static int faceOfNormal(const Vec3i &n) {
+    for (int f = 0; f < 6; ++f)
+        if (FACE_NORMAL[f] == n) return f;
+    return -1;
+}
+
+static int faceletAt(const Vec3i &pos, int face) {
+    for (int f = face * 9; f < face * 9 + 9; ++f) {
+        int x, y, z, fc;
+        CubeState::faceletPosition(f, x, y, z, fc);
+        if (Vec3i(x, y, z) == pos) return f;
+    }
+    return -1;
+}
+
+// Slot containing a facelet, and the facelet's index within the slot;
+// -1 for both if no slot has it
+template <int N, int K>
+static int slotOf(const uint8_t (&slots)[N][K], int facelet, int &index) {
+    index = -1;
+    for (int i = 0; i < N; ++i)
+        for (int k = 0; k < K; ++k)
+            if (slots[i][k] == facelet) { index = k; return i; }
+    return -1;
+}
+
+// Cubie whose home faces are exactly the given colours
+template <int N, int K>
+static int cubieWithColors(const uint8_t (&slots)[N][K], const int colors[K]) {
+    for (int i = 0; i < N; ++i) {
+        int found = 0;
+        for (int k = 0; k < K; ++k)
+            for (int j = 0; j < K; ++j)
+                if (slots[i][k] / 9 == colors[j]) ++found;
+        if (found == K) return i;
+    }
+    return -1;
+}
+
+// Conjugation of one (slot, cubie, twist) via the facelet maps
+template <int N, int K>
+static void conjugateSlot(const uint8_t (&slots)[N][K], const uint8_t *facelet_map,
+                          const uint8_t *face_map, int slot, int cubie, int twist,
+                          int &new_slot, int &new_cubie, int &new_twist) {
+    int pos[K], col[K];
+    for (int k = 0; k < K; ++k) {
+        pos[k] = facelet_map[slots[slot][(k + twist) % K]];
+        col[k] = face_map[slots[cubie][k] / 9];
+    }
+    int index;
+    new_slot = slotOf(slots, pos[0], index);
+    new_cubie = cubieWithColors(slots, col);
+
+    // Twist is where the new cubie's reference colour ended up
+    int ref = slots[new_cubie][0] / 9;
+    new_twist = 0;
+    for (int k = 0; k < K; ++k)
+        if (col[k] == ref) slotOf(slots, pos[k], new_twist);
+}
+
+SymmetryTables::SymmetryTables() {
+    static const int perms[6][3] = {{0, 1, 2}, {1, 2, 0}, {2, 0, 1}, {0, 2, 1}, {2, 1, 0}, {1, 0, 2}};
+    static const int parity[6] = {1, 1, 1, -1, -1, -1};
+
+    // Signed permutation matrices; rotations (det +1) first
+    int count[2] = {0, NUM_ROTATIONS};
+    for (int p = 0; p < 6; ++p) {
+        for (int signs = 0; signs < 8; ++signs) {
+            int8_t m[3][3];
+            memset(m, 0, sizeof(m));
+            int det = parity[p];
+            for (int r = 0; r < 3; ++r) {
+                int sign = (signs >> r) & 1 ? -1 : 1;
+                m[r][perms[p][r]] = int8_t(sign);
+                det *= sign;
+            }
+            int s = count[det > 0 ? 0 : 1]++;
+            memcpy(matrix[s], m, sizeof(m));
+        }
+    }
+
+    for (int s = 0; s < NUM_SYMMETRIES; ++s) {
+        for (int f = 0; f < 6; ++f)
+            faceMap[s][f] = uint8_t(faceOfNormal(transform(matrix[s], FACE_NORMAL[f])));
+        for (int f = 0; f < NUM_FACELETS; ++f) {
+            int x, y, z, face;
+            CubeState::faceletPosition(f, x, y, z, face);
+            faceletMap[s][f] = uint8_t(faceletAt(transform(matrix[s], Vec3i(x, y, z)), faceMap[s][face]));
+        }
+    }
+
+    // Inverse symmetry: the matrices are orthogonal, so the transpose
+    for (int s = 0; s < NUM_SYMMETRIES; ++s) {
+        for (int t = 0; t < NUM_SYMMETRIES; ++t) {
+            bool transposed = true;
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 3; ++c)
+                    if (matrix[s][r][c] != matrix[t][c][r]) transposed = false;
+            if (transposed) inverse[s] = uint8_t(t);
+        }
+    }
+
+    memset(cornerByte, 0, sizeof(cornerByte));
+    memset(edgeByte, 0, sizeof(edgeByte));
+    for (int s = 0; s < NUM_SYMMETRIES; ++s) {
+        for (int i = 0; i < NUM_CORNERS; ++i) {
+            for (int c = 0; c < NUM_CORNERS; ++c) {
+                for (int t = 0; t < 3; ++t) {
+                    int slot, cubie, twist;
+                    conjugateSlot(CORNER_FACELET, faceletMap[s], faceMap[s], i, c, t, slot, cubie, twist);
+                    cornerSlot[s][i] = uint8_t(slot);
+                    cornerByte[s][i][c | (t << 3)] = uint8_t(cubie | (twist << 3));
+                }
+            }
+        }
+        for (int i = 0; i < NUM_EDGES; ++i) {
+            for (int e = 0; e < NUM_EDGES; ++e) {
+                for (int f = 0; f < 2; ++f) {
+                    int slot, cubie, flip;
+                    conjugateSlot(EDGE_FACELET, faceletMap[s], faceMap[s], i, e, f, slot, cubie, flip);
+                    edgeSlot[s][i] = uint8_t(slot);
+                    edgeByte[s][i][e | (f << 4)] = uint8_t(cubie | (flip << 4));
+                }
+            }
+        }
+    }
+}
+
+const SymmetryTables &symmetryTables() {
+    static const SymmetryTables tables;
+    return tables;
+}
+
+// --------------- conjugation ------------------------------------------------
+static inline void conjugateInto(const SymmetryTables &t, const CubeState &in, CubeState &out, int s) {
+    for (int i = 0; i < NUM_CORNERS; ++i) out.corners[t.cornerSlot[s][i]] = t.cornerByte[s][i][in.corners[i]];
+    for (int i = 0; i < NUM_EDGES; ++i)   out.edges[t.edgeSlot[s][i]]     = t.edgeByte[s][i][in.edges[i]];
+    for (int i = 0; i < 6; ++i)           out.centers[t.faceMap[s][i]]    = t.faceMap[s][in.centers[i]];
+}
+
+CubeState conjugate(const CubeState &state, int sym) {
+    CubeState out;
+    conjugateInto(symmetryTables(), state, out, sym);
+    return out;
+}
+
+CubeState canonicalState(const CubeState &state, bool use_mirrors, bool use_inverse, int *sym_out) {
+    const SymmetryTables &t = symmetryTables();
+    int num_syms = use_mirrors ? NUM_SYMMETRIES : NUM_ROTATIONS;
+
+    CubeState sources[2];
+    sources[0] = state;
+    if (use_inverse) sources[1] = state.inverse();
+
+    CubeState best = state, candidate;
+    int best_sym = 0;
+    for (int src = 0; src < (use_inverse ? 2 : 1); ++src) {
+        for (int s = 0; s < num_syms; ++s) {
+            conjugateInto(t, sources[src], candidate, s);
+            if (memcmp(&candidate, &best, sizeof(CubeState)) < 0) {
+                best = candidate;
+                best_sym = s + src * NUM_SYMMETRIES;
+            }
+        }
+    }
+    if (sym_out) *sym_out = best_sym;
+    return best;
+}
@@ -0,0 +1,42 @@
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+#include "CubeState.h"
+#include <cstddef>
+
+// The 48 spatial symmetries of the cube: symmetries 0..23 are the proper
+// rotations (0 = identity), 24..47 the same rotations combined with a
+// mirror through the origin.
+const int NUM_SYMMETRIES = 48;
+const int NUM_ROTATIONS = 24;
+
+// Precomputed conjugation tables. Conjugating a state by a symmetry moves
+// every sticker with the symmetry and recolours it so centers stay home;
+// the result is again a legal state.
+struct SymmetryTables {
+    int8_t matrix[NUM_SYMMETRIES][3][3];
+    uint8_t inverse[NUM_SYMMETRIES];
+    uint8_t faceMap[NUM_SYMMETRIES][6];
+    uint8_t faceletMap[NUM_SYMMETRIES][NUM_FACELETS];
+
+    // Slot i moves to *Slot[s][i] and its packed byte b becomes *Byte[s][i][b]
+    uint8_t cornerSlot[NUM_SYMMETRIES][NUM_CORNERS];
+    uint8_t cornerByte[NUM_SYMMETRIES][NUM_CORNERS][24];
+    uint8_t edgeSlot[NUM_SYMMETRIES][NUM_EDGES];
+    uint8_t edgeByte[NUM_SYMMETRIES][NUM_EDGES][32];
+
+    SymmetryTables();
+};
+
+const SymmetryTables &symmetryTables();
+
+CubeState conjugate(const CubeState &state, int sym);
+
+// Smallest state (bytewise) among the conjugates of state under the 24
+// rotations, or all 48 symmetries, optionally also those of its inverse.
+// Equivalent states map to the same canonical state. *sym_out receives the
+// symmetry used, plus NUM_SYMMETRIES when it was applied to the inverse.
+CubeState canonicalState(const CubeState &state, bool use_mirrors = true,
+                         bool use_inverse = false, int *sym_out = NULL);
+
+#endif // SYMMETRY_H
@@ -0,0 +1,270 @@
+#include "TableFile.h"
+#include "Log.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char TABLE_MAGIC[8] = {'R', 'U', 'B', 'I', 'K', 'T', 'B', 'L'};
+static const size_t TABLE_NAME_SIZE = 48;
+static const size_t TABLE_ALIGN = 4096;
+
+struct TableHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint64_t checksum;
+};
+
+struct TableEntry {
+    char name[TABLE_NAME_SIZE];
+    uint64_t offset;
+    uint64_t size;
+    uint64_t checksum;
+};
+
+// FNV-1a over 64-bit words
+static uint64_t checksum(const void *data, size_t size) {
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    uint64_t h = 14695981039346656037ull;
+    size_t words = size / 8;
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t w;
+        memcpy(&w, p + i * 8, 8);
+        h = (h ^ w) * 1099511628211ull;
+    }
+    for (size_t i = words * 8; i < size; ++i) h = (h ^ p[i]) * 1099511628211ull;
+    return h;
+}
+
+static bool fail(std::string *error, const std::string &message) {
+    if (error) *error = message;
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+TableFile::TableFile() : base(NULL), length(0), mapped(false) {}
+
+TableFile::~TableFile() {
+    close();
+}
+
+void TableFile::close() {
+    if (base) {
+#if !defined(_WIN32)
+        if (mapped) munmap(const_cast<uint8_t *>(base), length);
+        else
+#endif
+            free(const_cast<uint8_t *>(base));
+    }
+    base = NULL;
+    length = 0;
+    mapped = false;
+    sections.clear();
+    checksums.clear();
+}
+
+bool TableFile::open(const std::string &path, std::string *error) {
+    close();
+
+#if !defined(_WIN32)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return fail(error, "cannot open " + path);
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(TableHeader)) {
+        ::close(fd);
+        return fail(error, path + " is not a table file");
+    }
+    length = size_t(st.st_size);
+    void *p = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        length = 0;
+        return fail(error, "cannot map " + path);
+    }
+    // Lookups are random; don't read ahead of them
+    madvise(p, length, MADV_RANDOM);
+    base = static_cast<const uint8_t *>(p);
+    mapped = true;
+#else
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) return fail(error, "cannot open " + path);
+    fseek(f, 0, SEEK_END);
+    length = size_t(ftell(f));
+    fseek(f, 0, SEEK_SET);
+    uint8_t *copy = static_cast<uint8_t *>(malloc(length ? length : 1));
+    bool ok = copy && fread(copy, 1, length, f) == length;
+    fclose(f);
+    if (!ok || length < sizeof(TableHeader)) {
+        free(copy);
+        length = 0;
+        return fail(error, path + " is not a table file");
+    }
+    base = copy;
+#endif
+
+    TableHeader header;
+    memcpy(&header, base, sizeof(header));
+    std::string problem;
+    if (memcmp(header.magic, TABLE_MAGIC, sizeof(TABLE_MAGIC)) != 0) {
+        problem = "not a table file";
+    } else if (header.version != TABLE_FILE_VERSION) {
+        problem = "table format version " + std::to_string(header.version) + ", expected " +
+                  std::to_string(TABLE_FILE_VERSION);
+    } else if (header.count > (length - sizeof(header)) / sizeof(TableEntry)) {
+        problem = "truncated directory";
+    } else if (checksum(base + sizeof(header), header.count * sizeof(TableEntry)) != header.checksum) {
+        problem = "directory checksum mismatch";
+    }
+
+    for (uint32_t i = 0; i < header.count && problem.empty(); ++i) {
+        TableEntry e;
+        memcpy(&e, base + sizeof(header) + i * sizeof(TableEntry), sizeof(e));
+        if (e.offset > length || e.size > length - e.offset) {
+            problem = "section out of bounds";
+            break;
+        }
+        e.name[TABLE_NAME_SIZE - 1] = '\0';
+        TableSection s = {e.name, base + e.offset, size_t(e.size)};
+        sections.push_back(s);
+        checksums.push_back(e.checksum);
+    }
+
+    if (!problem.empty()) {
+        close();
+        return fail(error, path + ": " + problem);
+    }
+    return true;
+}
+
+const void *TableFile::find(const std::string &name, size_t size) const {
+    for (size_t i = 0; i < sections.size(); ++i)
+        if (sections[i].name == name && sections[i].size == size) return sections[i].data;
+    return NULL;
+}
+
+const void *TableFile::findVerified(const std::string &name, size_t size, std::string *error) const {
+    for (size_t i = 0; i < sections.size(); ++i) {
+        if (sections[i].name != name || sections[i].size != size) continue;
+        if (checksum(sections[i].data, size) != checksums[i]) {
+            fail(error, "checksum mismatch in section " + name);
+            return NULL;
+        }
+        return sections[i].data;
+    }
+    return NULL;
+}
+
+bool TableFile::verify(std::string *error) const {
+    for (size_t i = 0; i < sections.size(); ++i)
+        if (checksum(sections[i].data, sections[i].size) != checksums[i])
+            return fail(error, "checksum mismatch in section " + sections[i].name);
+    return true;
+}
+
+bool TableFile::write(const std::string &path, const std::vector<TableSection> &sections,
+                      std::string *error) {
+    TableHeader header;
+    memcpy(header.magic, TABLE_MAGIC, sizeof(TABLE_MAGIC));
+    header.version = TABLE_FILE_VERSION;
+    header.count = uint32_t(sections.size());
+
+    std::vector<TableEntry> entries(sections.size());
+    uint64_t offset = sizeof(header) + sections.size() * sizeof(TableEntry);
+    for (size_t i = 0; i < sections.size(); ++i) {
+        if (sections[i].name.size() >= TABLE_NAME_SIZE) return fail(error, "section name too long: " + sections[i].name);
+        memset(&entries[i], 0, sizeof(TableEntry));
+        memcpy(entries[i].name, sections[i].name.c_str(), sections[i].name.size());
+        offset = (offset + TABLE_ALIGN - 1) / TABLE_ALIGN * TABLE_ALIGN;
+        entries[i].offset = offset;
+        entries[i].size = sections[i].size;
+        entries[i].checksum = checksum(sections[i].data, sections[i].size);
+        offset += sections[i].size;
+    }
+    header.checksum = entries.empty() ? checksum(NULL, 0) : checksum(&entries[0], entries.size() * sizeof(TableEntry));
+
+    std::string temp = path + ".tmp";
+    FILE *f = fopen(temp.c_str(), "wb");
+    if (!f) return fail(error, "cannot create " + temp);
+
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    if (!entries.empty()) ok = ok && fwrite(&entries[0], sizeof(TableEntry), entries.size(), f) == entries.size();
+    uint64_t pos = sizeof(header) + entries.size() * sizeof(TableEntry);
+    static const uint8_t zeros[TABLE_ALIGN] = {0};
+    for (size_t i = 0; i < sections.size() && ok; ++i) {
+        ok = fwrite(zeros, 1, size_t(entries[i].offset - pos), f) == entries[i].offset - pos;
+        ok = ok && fwrite(sections[i].data, 1, sections[i].size, f) == sections[i].size;
+        pos = entries[i].offset + sections[i].size;
+    }
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok || rename(temp.c_str(), path.c_str()) != 0) {
+        remove(temp.c_str());
+        return fail(error, "cannot write " + path);
+    }
+    return true;
+}
+
+// --------------- shared file ------------------------------------------------
+static std::string &tablePathStorage() {
+    static std::string path = getenv("RUBIK_TABLES") ? getenv("RUBIK_TABLES") : "rubik_tables.bin";
+    return path;
+}
+
+const std::string &tableFilePath() {
+    return tablePathStorage();
+}
+
+void setTableFilePath(const std::string &path) {
+    tablePathStorage() = path;
+}
+
+static bool &tableVerificationStorage() {
+    static bool on = getenv("RUBIK_TABLES_VERIFY") != NULL;
+    return on;
+}
+
+bool tableVerification() {
+    return tableVerificationStorage();
+}
+
+void setTableVerification(bool on) {
+    tableVerificationStorage() = on;
+}
+
+struct SharedTableFile {
+    TableFile file;
+
+    SharedTableFile() {
+        const std::string &path = tableFilePath();
+        if (path.empty()) return;
+        std::string error;
+        if (file.open(path, &error)) {
+            LOG_INFO("Mapped lookup tables from %s", path.c_str());
+        } else {
+            LOG_INFO("No usable table file (%s); tables will be generated", error.c_str());
+        }
+    }
+};
+
+const TableFile &sharedTableFile() {
+    static const SharedTableFile shared;
+    return shared.file;
+}
+
+// --------------- table sets -------------------------------------------------
+const void *TableSet::lookup(const char *name, size_t size) {
+    std::string error;
+    const TableFile &file = sharedTableFile();
+    const void *data = tableVerification() ? file.findVerified(prefix + name, size, &error)
+                                           : file.find(prefix + name, size);
+    if (data) add(name, data, size);
+    else if (!error.empty()) LOG_WARN("%s; generating it instead", error.c_str());
+    return data;
+}
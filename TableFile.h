@@ -0,0 +1,133 @@
+#ifndef TABLE_FILE_H
+#define TABLE_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// On-disk lookup tables.
+//
+// A table file is a header, a directory of named sections and the section
+// data, each section starting on a 4 KB boundary:
+//
+//   header     "RUBIKTBL", uint32 format version, uint32 section count,
+//              uint64 checksum of the directory
+//   directory  per section: char name[48], uint64 offset, size, checksum
+//
+// The file is mapped read-only, so its pages are loaded on first touch
+// and shared through the page cache by every process using it. Opening
+// checks the header and directory only. Section checksums are compared by
+// verify(), and by TableSet when setTableVerification(true) is on; both
+// read every page. Otherwise a damaged section is used as it is and solver
+// behaviour is undefined, so run rubik_tables --verify on a file before
+// deploying it. Bump TABLE_FILE_VERSION whenever the layout of any table
+// changes.
+const uint32_t TABLE_FILE_VERSION = 1;
+
+struct TableSection {
+    std::string name;
+    const void *data;
+    size_t size;
+};
+
+class TableFile {
+public:
+    TableFile();
+    ~TableFile();
+
+    bool open(const std::string &path, std::string *error = NULL);
+    void close();
+    bool isOpen() const { return base != NULL; }
+
+    // Section data, or NULL if the file has no section of that name and size
+    const void *find(const std::string &name, size_t size) const;
+    // Same, but also NULL when the data does not match its checksum, with
+    // the reason in *error
+    const void *findVerified(const std::string &name, size_t size, std::string *error = NULL) const;
+
+    // Compare every section against its checksum
+    bool verify(std::string *error = NULL) const;
+
+    const std::vector<TableSection> &getSections() const { return sections; }
+
+    // Writes through a temporary file renamed into place, so readers never
+    // see a partial file
+    static bool write(const std::string &path, const std::vector<TableSection> &sections,
+                      std::string *error = NULL);
+
+private:
+    const uint8_t *base;
+    size_t length;
+    bool mapped;                        // else base is a heap copy
+    std::vector<TableSection> sections;
+    std::vector<uint64_t> checksums;
+
+    TableFile(const TableFile &);
+    TableFile &operator=(const TableFile &);
+};
+
+// Table file shared by the solvers: $RUBIK_TABLES if set, else
+// "rubik_tables.bin" in the working directory. An empty path disables it.
+// Must be set before the first solver tables are built.
+const std::string &tableFilePath();
+void setTableFilePath(const std::string &path);
+
+// Whether TableSet checks each section's checksum before using it: off
+// unless $RUBIK_TABLES_VERIFY is set. Must be set before the first solver
+// tables are built.
+bool tableVerification();
+void setTableVerification(bool on);
+
+// The table file at tableFilePath(), opened on first use (empty if missing)
+const TableFile &sharedTableFile();
+
+// The tables of one solver: each section is taken from the shared table
+// file when present there with the expected size (and checksum, with
+// tableVerification() on), and generated into owned memory otherwise.
+class TableSet {
+public:
+    explicit TableSet(const std::string &prefix) : prefix(prefix), generated(false) {}
+
+    // Mapped data for a section, or NULL when it has to be generated
+    template <typename T>
+    const T *find(const char *name, size_t count) {
+        return static_cast<const T *>(lookup(name, count * sizeof(T)));
+    }
+
+    // Zeroed owned memory for a section about to be generated
+    template <typename T>
+    T *allocate(const char *name, size_t count) {
+        storage.push_back(std::vector<uint8_t>(count * sizeof(T)));
+        T *data = reinterpret_cast<T *>(storage.back().data());
+        add(name, data, count * sizeof(T));
+        generated = true;
+        return data;
+    }
+
+    // Mapped section, or generated by build(T *) when missing
+    template <typename T, typename Build>
+    const T *section(const char *name, size_t count, Build build) {
+        if (const T *data = find<T>(name, count)) return data;
+        T *data = allocate<T>(name, count);
+        build(data);
+        return data;
+    }
+
+    bool anyGenerated() const { return generated; }
+    const std::vector<TableSection> &getSections() const { return sections; }
+
+private:
+    const void *lookup(const char *name, size_t size);
+    void add(const char *name, const void *data, size_t size) {
+        TableSection s = {prefix + name, data, size};
+        sections.push_back(s);
+    }
+
+    std::string prefix;
+    std::vector<std::vector<uint8_t> > storage;
+    std::vector<TableSection> sections;
+    bool generated;
+};
+
+#endif // TABLE_FILE_H
@@ -0,0 +1,211 @@
+#include "ThistlethwaiteSolver.h"
+
+static const Move PHASE1_MOVES[THISTLE_NUM_MOVES_1] = {
+    MOVE_U, MOVE_U2, MOVE_U3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_F, MOVE_F2, MOVE_F3,
+    MOVE_D, MOVE_D2, MOVE_D3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_B, MOVE_B2, MOVE_B3
+};
+static const Move PHASE2_MOVES[THISTLE_NUM_MOVES_2] = {
+    MOVE_U, MOVE_U2, MOVE_U3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_F2,
+    MOVE_D, MOVE_D2, MOVE_D3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_B2
+};
+static const Move PHASE3_MOVES[THISTLE_NUM_MOVES_3] = {
+    MOVE_U, MOVE_U2, MOVE_U3, MOVE_R2, MOVE_F2, MOVE_D, MOVE_D2, MOVE_D3, MOVE_L2, MOVE_B2
+};
+static const Move PHASE4_MOVES[THISTLE_NUM_MOVES_4] = {
+    MOVE_U2, MOVE_R2, MOVE_F2, MOVE_D2, MOVE_L2, MOVE_B2
+};
+// PHASE4_MOVES within PHASE3_MOVES
+static const int HALF_TURNS_3[THISTLE_NUM_MOVES_4] = {1, 3, 4, 6, 8, 9};
+
+// Move table of a coordinate with a single value, for one-coordinate tables
+static const uint16_t NO_COORD_MOVE[THISTLE_NUM_MOVES_1] = {0};
+
+// --------------- phase coordinates ------------------------------------------
+// Slots of the M-slice edges and the S-slice edges in the U and D layers
+static const int M_SLOTS[4] = {UF, UB, DF, DB};
+static const int S_SLOTS[4] = {UR, UL, DR, DL};
+
+static bool isMSliceEdge(int cubie) {
+    return cubie == UF || cubie == UB || cubie == DF || cubie == DB;
+}
+
+// Which of the eight U/D-layer slots hold M-slice edges; the middle layer
+// must hold its own edges
+static int mSliceCoord(const CubeState &s) {
+    int slice = 0, found = 0;
+    for (int j = 7; j >= 0; --j) {
+        if (isMSliceEdge(s.edgeCubie(j))) {
+            slice += binomial(7 - j, found + 1);
+            ++found;
+        }
+    }
+    return slice;
+}
+
+static void setMSliceCoord(CubeState &s, int slice) {
+    int left = 4, next_m = 0, next_s = 0;
+    for (int j = 0; j < 8; ++j) {
+        int c = binomial(7 - j, left);
+        int cubie;
+        if (left > 0 && slice - c >= 0) {
+            slice -= c;
+            --left;
+            cubie = M_SLOTS[next_m++];
+        } else {
+            cubie = S_SLOTS[next_s++];
+        }
+        s.edges[j] = uint8_t(cubie | (s.edgeFlip(j) << 4));
+    }
+}
+
+// Permutation of four edges within their four slots, cubies ranked by slot order
+static int slotPermCoord(const CubeState &s, const int *slots) {
+    uint8_t perm[4];
+    for (int i = 0; i < 4; ++i)
+        for (int k = 0; k < 4; ++k)
+            if (s.edgeCubie(slots[i]) == slots[k]) perm[i] = uint8_t(k);
+    return permutationRank(perm, 4);
+}
+
+static void setSlotPermCoord(CubeState &s, const int *slots, int perm) {
+    uint8_t p[4];
+    permutationUnrank(perm, p, 4);
+    for (int i = 0; i < 4; ++i) s.edges[slots[i]] = uint8_t(slots[p[i]] | (s.edgeFlip(slots[i]) << 4));
+}
+
+// The edges of all three slices, once each stays in its own slice
+static int g3EdgeCoord(const CubeState &s) {
+    return (slicePermCoord(s) * 24 + slotPermCoord(s, M_SLOTS)) * 24 + slotPermCoord(s, S_SLOTS);
+}
+
+static void setG3EdgeCoord(CubeState &s, int edges) {
+    setSlotPermCoord(s, S_SLOTS, edges % 24);
+    setSlotPermCoord(s, M_SLOTS, edges / 24 % 24);
+    setSlicePermCoord(s, edges / 576);
+}
+
+// --------------- tables -----------------------------------------------------
+ThistlethwaiteTables::ThistlethwaiteTables() : sections("thistlethwaite/") {
+    flipMove = sections.section<uint16_t>("flip_move", NUM_FLIP * THISTLE_NUM_MOVES_1, [](uint16_t *t) {
+        buildCoordMoveTable(t, NUM_FLIP, PHASE1_MOVES, THISTLE_NUM_MOVES_1, flipCoord, setFlipCoord);
+    });
+    twistMove = sections.section<uint16_t>("twist_move", NUM_TWIST * THISTLE_NUM_MOVES_2, [](uint16_t *t) {
+        buildCoordMoveTable(t, NUM_TWIST, PHASE2_MOVES, THISTLE_NUM_MOVES_2, twistCoord, setTwistCoord);
+    });
+    sliceMove = sections.section<uint16_t>("slice_move", NUM_UD_SLICE * THISTLE_NUM_MOVES_2, [](uint16_t *t) {
+        buildCoordMoveTable(t, NUM_UD_SLICE, PHASE2_MOVES, THISTLE_NUM_MOVES_2, udSliceCoord, setUDSliceCoord);
+    });
+    cornerPermMove = sections.section<uint16_t>("corner_perm_move", NUM_CORNER_PERM * THISTLE_NUM_MOVES_3,
+                                                [](uint16_t *t) {
+        buildCoordMoveTable(t, NUM_CORNER_PERM, PHASE3_MOVES, THISTLE_NUM_MOVES_3,
+                            cornerPermCoord, setCornerPermCoord);
+    });
+    mSliceMove = sections.section<uint16_t>("m_slice_move", NUM_M_SLICE * THISTLE_NUM_MOVES_3, [](uint16_t *t) {
+        buildCoordMoveTable(t, NUM_M_SLICE, PHASE3_MOVES, THISTLE_NUM_MOVES_3, mSliceCoord, setMSliceCoord);
+    });
+
+    // Number the corner permutations reachable from solved by half turns
+    g3CornerIndex = sections.section<uint16_t>("g3_corner_index", NUM_CORNER_PERM, [this](uint16_t *t) {
+        for (int i = 0; i < NUM_CORNER_PERM; ++i) t[i] = 0xffff;
+        std::vector<uint16_t> list(1, 0);
+        t[0] = 0;
+        for (size_t i = 0; i < list.size(); ++i) {
+            for (int m = 0; m < THISTLE_NUM_MOVES_4; ++m) {
+                uint16_t next = cornerPermMove[list[i] * THISTLE_NUM_MOVES_3 + HALF_TURNS_3[m]];
+                if (t[next] != 0xffff) continue;
+                t[next] = uint16_t(list.size());
+                list.push_back(next);
+            }
+        }
+    });
+    g3CornerMove = sections.section<uint16_t>("g3_corner_move", NUM_G3_CORNERS * THISTLE_NUM_MOVES_4,
+                                              [this](uint16_t *t) {
+        for (int perm = 0; perm < NUM_CORNER_PERM; ++perm) {
+            int index = g3CornerIndex[perm];
+            if (index == 0xffff) continue;
+            for (int m = 0; m < THISTLE_NUM_MOVES_4; ++m)
+                t[index * THISTLE_NUM_MOVES_4 + m] =
+                    g3CornerIndex[cornerPermMove[perm * THISTLE_NUM_MOVES_3 + HALF_TURNS_3[m]]];
+        }
+    });
+    g3EdgeMove = sections.section<uint16_t>("g3_edge_move", NUM_G3_EDGES * THISTLE_NUM_MOVES_4, [](uint16_t *t) {
+        buildCoordMoveTable(t, NUM_G3_EDGES, PHASE4_MOVES, THISTLE_NUM_MOVES_4, g3EdgeCoord, setG3EdgeCoord);
+    });
+
+    flipDist = sections.section<uint8_t>("flip_dist", NUM_FLIP, [this](uint8_t *t) {
+        buildPruningTable(t, flipMove, NUM_FLIP, NO_COORD_MOVE, 1, THISTLE_NUM_MOVES_1);
+    });
+    twistSliceDist = sections.section<uint8_t>("twist_slice_dist", NUM_TWIST * NUM_UD_SLICE, [this](uint8_t *t) {
+        buildPruningTable(t, twistMove, NUM_TWIST, sliceMove, NUM_UD_SLICE, THISTLE_NUM_MOVES_2);
+    });
+    // Goal: any G3 corner permutation with the M-slice edges home
+    cornerMSliceDist = sections.section<uint8_t>("corner_m_slice_dist", NUM_CORNER_PERM * NUM_M_SLICE,
+                                                 [this](uint8_t *t) {
+        uint32_t home = uint32_t(mSliceCoord(CubeState()));
+        std::vector<uint32_t> goals;
+        for (uint32_t perm = 0; perm < uint32_t(NUM_CORNER_PERM); ++perm)
+            if (g3CornerIndex[perm] != 0xffff) goals.push_back(perm * NUM_M_SLICE + home);
+        buildPruningTable(t, cornerPermMove, NUM_CORNER_PERM, mSliceMove, NUM_M_SLICE, THISTLE_NUM_MOVES_3, goals);
+    });
+    g3Dist = sections.section<uint8_t>("g3_dist", NUM_G3_CORNERS * NUM_G3_EDGES, [this](uint8_t *t) {
+        buildPruningTable(t, g3CornerMove, NUM_G3_CORNERS, g3EdgeMove, NUM_G3_EDGES, THISTLE_NUM_MOVES_4);
+    });
+}
+
+const ThistlethwaiteTables &thistlethwaiteTables() {
+    static const ThistlethwaiteTables tables;
+    return tables;
+}
+
+// --------------- solver -----------------------------------------------------
+// Follow a distance table over coordinates (a, b) down to 0, appending the
+// moves taken and applying them to state. False if the start is unreached.
+static bool descend(const uint8_t *dist, const uint16_t *move_a, const uint16_t *move_b, int num_b,
+                    const Move *moves, int num_moves, int a, int b, CubeState &state, MoveSequence &out) {
+    int d = dist[a * num_b + b];
+    if (d == 0xff) return false;
+    while (d > 0) {
+        int m = 0;
+        int na = 0, nb = 0;
+        for (; m < num_moves; ++m) {
+            na = move_a[a * num_moves + m];
+            nb = move_b[b * num_moves + m];
+            if (dist[na * num_b + nb] == d - 1) break;
+        }
+        if (m == num_moves) return false;
+        applyMove(state, moves[m]);
+        out.append(moves[m]);
+        a = na;
+        b = nb;
+        --d;
+    }
+    return true;
+}
+
+ThistlethwaiteSolver::ThistlethwaiteSolver() {
+    thistlethwaiteTables();
+}
+
+bool ThistlethwaiteSolver::solve(const CubeState &state, MoveSequence &solution, std::string *error) const {
+    if (!checkSolvable(state, error)) return false;
+    const ThistlethwaiteTables &t = thistlethwaiteTables();
+
+    CubeState s = state;
+    MoveSequence result;
+    orientCenters(s, result);
+
+    bool ok = descend(t.flipDist, t.flipMove, NO_COORD_MOVE, 1, PHASE1_MOVES, THISTLE_NUM_MOVES_1,
+                      flipCoord(s), 0, s, result) &&
+              descend(t.twistSliceDist, t.twistMove, t.sliceMove, NUM_UD_SLICE, PHASE2_MOVES, THISTLE_NUM_MOVES_2,
+                      twistCoord(s), udSliceCoord(s), s, result) &&
+              descend(t.cornerMSliceDist, t.cornerPermMove, t.mSliceMove, NUM_M_SLICE, PHASE3_MOVES,
+                      THISTLE_NUM_MOVES_3, cornerPermCoord(s), mSliceCoord(s), s, result) &&
+              descend(t.g3Dist, t.g3CornerMove, t.g3EdgeMove, NUM_G3_EDGES, PHASE4_MOVES, THISTLE_NUM_MOVES_4,
+                      t.g3CornerIndex[cornerPermCoord(s)], g3EdgeCoord(s), s, result);
+    if (!ok || !s.isSolved()) {
+        if (error) *error = "no solution found";
+        return false;
+    }
+    solution = result;
+    return true;
+}
@@ -0,0 +1,66 @@
+#ifndef THISTLETHWAITE_SOLVER_H
+#define THISTLETHWAITE_SOLVER_H
+
+#include "Solver.h"
+#include "CubeCoords.h"
+#include "TableFile.h"
+
+// Thistlethwaite's four-phase algorithm.
+//
+// Each phase moves the cube into a smaller subgroup using only the moves
+// of the current one:
+//
+//   G0 = <U, D, R, L, F, B>      orient every edge
+//   G1 = <U, D, R, L, F2, B2>    orient every corner, middle edges into the middle layer
+//   G2 = <U, D, R2, L2, F2, B2>  corners into their tetrads, M-slice edges into the M slice
+//   G3 = <U2, D2, R2, L2, F2, B2>  solve with half turns
+//   G4 = solved
+//
+// Every phase table holds the exact distance to the next subgroup over the
+// whole phase state, so each phase is solved optimally by walking the
+// table downhill. No search is needed, the tables total about 6 MB and
+// solutions are 30 to 45 moves long.
+const int THISTLE_NUM_MOVES_1 = 18;  // G0: every face move
+const int THISTLE_NUM_MOVES_2 = 14;  // G1
+const int THISTLE_NUM_MOVES_3 = 10;  // G2
+const int THISTLE_NUM_MOVES_4 = 6;   // G3
+
+const int NUM_M_SLICE = 70;          // C(8,4) U/D-layer slots holding the UF/UB/DF/DB edges
+const int NUM_G3_CORNERS = 96;       // corner permutations reachable by half turns
+const int NUM_G3_EDGES = 13824;      // 4!^3 edge permutations within the three slices
+
+struct ThistlethwaiteTables {
+    // Coordinate move tables, [coord * num_moves + move]
+    const uint16_t *flipMove;         // phase 1
+    const uint16_t *twistMove;        // phase 2
+    const uint16_t *sliceMove;
+    const uint16_t *cornerPermMove;   // phase 3
+    const uint16_t *mSliceMove;
+    const uint16_t *g3CornerMove;     // phase 4
+    const uint16_t *g3EdgeMove;
+
+    const uint16_t *g3CornerIndex;    // corner permutation -> G3 index, 0xffff outside G3
+
+    // Distances to the phase goal
+    const uint8_t *flipDist;
+    const uint8_t *twistSliceDist;
+    const uint8_t *cornerMSliceDist;
+    const uint8_t *g3Dist;
+
+    TableSet sections;                // mapped from the table file or generated
+
+    ThistlethwaiteTables();
+};
+
+// Built on first use (about 0.3 s) unless the table file has them
+const ThistlethwaiteTables &thistlethwaiteTables();
+
+class ThistlethwaiteSolver : public Solver {
+public:
+    ThistlethwaiteSolver();
+
+    const char *name() const { return "thistlethwaite"; }
+    bool solve(const CubeState &state, MoveSequence &solution, std::string *error = NULL) const;
+};
+
+#endif // THISTLETHWAITE_SOLVER_H
@@ -0,0 +1,193 @@
+#include "TwoPhaseSolver.h"
+#include <algorithm>
+#include <chrono>
+
+static const Move PHASE1_MOVES[TWO_PHASE_NUM_MOVES] = {
+    MOVE_U, MOVE_U2, MOVE_U3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_F, MOVE_F2, MOVE_F3,
+    MOVE_D, MOVE_D2, MOVE_D3, MOVE_L, MOVE_L2, MOVE_L3, MOVE_B, MOVE_B2, MOVE_B3
+};
+static const Move PHASE2_MOVES[TWO_PHASE_NUM_MOVES_2] = {
+    MOVE_U, MOVE_U2, MOVE_U3, MOVE_D, MOVE_D2, MOVE_D3, MOVE_R2, MOVE_F2, MOVE_L2, MOVE_B2
+};
+
+const int MAX_PHASE1 = 20;
+const int MAX_PHASE2 = 12;   // longer phase 2 tails are slow to find; take another phase 1
+const int MAX_SOLUTION = 31;
+
+TwoPhaseTables::TwoPhaseTables() : sections("twophase/") {
+    twistMove = sections.section<uint16_t>("twist_move", NUM_TWIST * TWO_PHASE_NUM_MOVES, [](uint16_t *t) {
+        buildCoordMoveTable(t, NUM_TWIST, PHASE1_MOVES, TWO_PHASE_NUM_MOVES, twistCoord, setTwistCoord);
+    });
+    flipMove = sections.section<uint16_t>("flip_move", NUM_FLIP * TWO_PHASE_NUM_MOVES, [](uint16_t *t) {
+        buildCoordMoveTable(t, NUM_FLIP, PHASE1_MOVES, TWO_PHASE_NUM_MOVES, flipCoord, setFlipCoord);
+    });
+    sliceMove = sections.section<uint16_t>("slice_move", NUM_UD_SLICE * TWO_PHASE_NUM_MOVES, [](uint16_t *t) {
+        buildCoordMoveTable(t, NUM_UD_SLICE, PHASE1_MOVES, TWO_PHASE_NUM_MOVES, udSliceCoord, setUDSliceCoord);
+    });
+    cornerPermMove = sections.section<uint16_t>("corner_perm_move", NUM_CORNER_PERM * TWO_PHASE_NUM_MOVES_2,
+                                                [](uint16_t *t) {
+        buildCoordMoveTable(t, NUM_CORNER_PERM, PHASE2_MOVES, TWO_PHASE_NUM_MOVES_2,
+                            cornerPermCoord, setCornerPermCoord);
+    });
+    udEdgePermMove = sections.section<uint16_t>("ud_edge_perm_move", NUM_UD_EDGE_PERM * TWO_PHASE_NUM_MOVES_2,
+                                                [](uint16_t *t) {
+        buildCoordMoveTable(t, NUM_UD_EDGE_PERM, PHASE2_MOVES, TWO_PHASE_NUM_MOVES_2,
+                            udEdgePermCoord, setUDEdgePermCoord);
+    });
+    slicePermMove = sections.section<uint16_t>("slice_perm_move", NUM_SLICE_PERM * TWO_PHASE_NUM_MOVES_2,
+                                               [](uint16_t *t) {
+        buildCoordMoveTable(t, NUM_SLICE_PERM, PHASE2_MOVES, TWO_PHASE_NUM_MOVES_2,
+                            slicePermCoord, setSlicePermCoord);
+    });
+
+    twistSlicePrune = sections.section<uint8_t>("twist_slice_prune", NUM_TWIST * NUM_UD_SLICE, [this](uint8_t *t) {
+        buildPruningTable(t, twistMove, NUM_TWIST, sliceMove, NUM_UD_SLICE, TWO_PHASE_NUM_MOVES);
+    });
+    flipSlicePrune = sections.section<uint8_t>("flip_slice_prune", NUM_FLIP * NUM_UD_SLICE, [this](uint8_t *t) {
+        buildPruningTable(t, flipMove, NUM_FLIP, sliceMove, NUM_UD_SLICE, TWO_PHASE_NUM_MOVES);
+    });
+    cornerSlicePrune = sections.section<uint8_t>("corner_slice_prune", NUM_CORNER_PERM * NUM_SLICE_PERM,
+                                                 [this](uint8_t *t) {
+        buildPruningTable(t, cornerPermMove, NUM_CORNER_PERM, slicePermMove, NUM_SLICE_PERM,
+                          TWO_PHASE_NUM_MOVES_2);
+    });
+    edgeSlicePrune = sections.section<uint8_t>("edge_slice_prune", NUM_UD_EDGE_PERM * NUM_SLICE_PERM,
+                                               [this](uint8_t *t) {
+        buildPruningTable(t, udEdgePermMove, NUM_UD_EDGE_PERM, slicePermMove, NUM_SLICE_PERM,
+                          TWO_PHASE_NUM_MOVES_2);
+    });
+}
+
+const TwoPhaseTables &twoPhaseTables() {
+    static const TwoPhaseTables tables;
+    return tables;
+}
+
+// --------------- search -----------------------------------------------------
+namespace {
+
+// Skip a move on the face just turned, and fix the order of opposite faces
+// (U then D is searched, D then U is not) since they commute
+inline bool redundant(Move move, int last) {
+    if (last < 0) return false;
+    int face = moveTurn(move), last_face = moveTurn(last);
+    return face == last_face || (face % 3 == last_face % 3 && face < last_face);
+}
+
+struct Search {
+    const TwoPhaseTables &t;
+    CubeState start;
+    Move path[MAX_SOLUTION];
+    Move best[MAX_SOLUTION];
+    int best_length;
+    int target_length;
+    std::chrono::steady_clock::time_point deadline;
+    unsigned long nodes;
+    bool done;
+
+    Search(const CubeState &s, int target, double timeout_ms)
+        : t(twoPhaseTables()), start(s), best_length(MAX_SOLUTION + 1), target_length(target), nodes(0), done(false) {
+        deadline = std::chrono::steady_clock::now() +
+                   std::chrono::microseconds(long(timeout_ms * 1000.0));
+    }
+
+    int phase1Distance(int twist, int flip, int slice) const {
+        return std::max(t.twistSlicePrune[twist * NUM_UD_SLICE + slice],
+                        t.flipSlicePrune[flip * NUM_UD_SLICE + slice]);
+    }
+
+    int phase2Distance(int corners, int edges, int slice) const {
+        return std::max(t.cornerSlicePrune[corners * NUM_SLICE_PERM + slice],
+                        t.edgeSlicePrune[edges * NUM_SLICE_PERM + slice]);
+    }
+
+    void run() {
+        int twist = twistCoord(start), flip = flipCoord(start), slice = udSliceCoord(start);
+        for (int depth = phase1Distance(twist, flip, slice); depth <= MAX_PHASE1 && !done; ++depth) {
+            if (depth >= best_length) break;
+            phase1(twist, flip, slice, 0, depth);
+        }
+    }
+
+    void phase1(int twist, int flip, int slice, int depth, int togo) {
+        if (togo == 0) {
+            // A phase 1 ending in a phase 2 move was already seen one move shorter
+            if (twist == 0 && flip == 0 && slice == 0) {
+                int last = depth > 0 ? path[depth - 1] : -1;
+                if (last < 0 || (movePower(last) != 2 && moveTurn(last) != TURN_U && moveTurn(last) != TURN_D))
+                    startPhase2(depth);
+            }
+            return;
+        }
+
+        if ((++nodes & 1023) == 0 && std::chrono::steady_clock::now() >= deadline)
+            done = true;
+
+        for (int m = 0; m < TWO_PHASE_NUM_MOVES && !done; ++m) {
+            if (depth > 0 && redundant(PHASE1_MOVES[m], path[depth - 1])) continue;
+            int nt = t.twistMove[twist * TWO_PHASE_NUM_MOVES + m];
+            int nf = t.flipMove[flip * TWO_PHASE_NUM_MOVES + m];
+            int ns = t.sliceMove[slice * TWO_PHASE_NUM_MOVES + m];
+            if (phase1Distance(nt, nf, ns) >= togo) continue;
+            path[depth] = PHASE1_MOVES[m];
+            phase1(nt, nf, ns, depth + 1, togo - 1);
+        }
+    }
+
+    void startPhase2(int length1) {
+        CubeState s = start;
+        applyMoves(s, path, length1);
+        int corners = cornerPermCoord(s), edges = udEdgePermCoord(s), slice = slicePermCoord(s);
+
+        int limit = std::min(best_length - 1 - length1, MAX_PHASE2);
+        for (int depth = phase2Distance(corners, edges, slice); depth <= limit; ++depth) {
+            if (phase2(corners, edges, slice, length1, depth)) {
+                best_length = length1 + depth;
+                std::copy(path, path + best_length, best);
+                if (best_length <= target_length) done = true;
+                return;
+            }
+        }
+    }
+
+    bool phase2(int corners, int edges, int slice, int depth, int togo) {
+        if (togo == 0) return corners == 0 && edges == 0 && slice == 0;
+        for (int m = 0; m < TWO_PHASE_NUM_MOVES_2; ++m) {
+            if (depth > 0 && redundant(PHASE2_MOVES[m], path[depth - 1])) continue;
+            int nc = t.cornerPermMove[corners * TWO_PHASE_NUM_MOVES_2 + m];
+            int ne = t.udEdgePermMove[edges * TWO_PHASE_NUM_MOVES_2 + m];
+            int ns = t.slicePermMove[slice * TWO_PHASE_NUM_MOVES_2 + m];
+            if (phase2Distance(nc, ne, ns) >= togo) continue;
+            path[depth] = PHASE2_MOVES[m];
+            if (phase2(nc, ne, ns, depth + 1, togo - 1)) return true;
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+// --------------- solver -----------------------------------------------------
+TwoPhaseSolver::TwoPhaseSolver(int target_length, double timeout_ms)
+    : target_length(target_length), timeout_ms(timeout_ms) {
+    twoPhaseTables();
+}
+
+bool TwoPhaseSolver::solve(const CubeState &state, MoveSequence &solution, std::string *error) const {
+    if (!checkSolvable(state, error)) return false;
+
+    CubeState s = state;
+    MoveSequence result;
+    orientCenters(s, result);
+
+    Search search(s, target_length, timeout_ms);
+    search.run();
+    if (search.best_length > MAX_SOLUTION) {
+        if (error) *error = search.done ? "timed out" : "no solution found";
+        return false;
+    }
+
+    for (int i = 0; i < search.best_length; ++i) result.append(search.best[i]);
+    solution = result;
+    return true;
+}
@@ -0,0 +1,64 @@
+#ifndef TWO_PHASE_SOLVER_H
+#define TWO_PHASE_SOLVER_H
+
+#include "Solver.h"
+#include "CubeCoords.h"
+#include "TableFile.h"
+
+// Kociemba's two-phase algorithm.
+//
+// Phase 1 searches face turns that orient every corner and edge and bring
+// the four middle-layer edges into the middle layer (twist, flip and
+// UD-slice coordinates all 0). That lands in the subgroup generated by
+// U, D, R2, L2, F2, B2, where phase 2 finishes the corner, U/D edge and
+// middle edge permutations with those ten moves only. Both phases are
+// IDA* searches over coordinate move tables, pruned by the larger of two
+// distance tables per phase. Phase 1 lengths are tried in increasing
+// order and every shorter total found tightens the bound, until the
+// target length or the time limit is reached.
+const int TWO_PHASE_NUM_MOVES = 18;     // phase 1: every face move
+const int TWO_PHASE_NUM_MOVES_2 = 10;   // phase 2: U, D, R2, L2, F2, B2
+
+struct TwoPhaseTables {
+    // Coordinate move tables, [coord * num_moves + move]
+    const uint16_t *twistMove;
+    const uint16_t *flipMove;
+    const uint16_t *sliceMove;
+    const uint16_t *cornerPermMove;
+    const uint16_t *udEdgePermMove;
+    const uint16_t *slicePermMove;
+
+    // Pruning tables: moves to the phase goal, at least
+    const uint8_t *twistSlicePrune;
+    const uint8_t *flipSlicePrune;
+    const uint8_t *cornerSlicePrune;
+    const uint8_t *edgeSlicePrune;
+
+    TableSet sections;                  // mapped from the table file or generated
+
+    TwoPhaseTables();
+};
+
+// Built on first use (about 5 MB, 0.3 s) unless the table file has them;
+// call early to keep it off the first solve
+const TwoPhaseTables &twoPhaseTables();
+
+class TwoPhaseSolver : public Solver {
+public:
+    // Stop at the first solution of at most target_length face moves, or
+    // return the best found once timeout_ms has passed; fails with "timed
+    // out" if none was found by then
+    explicit TwoPhaseSolver(int target_length = 20, double timeout_ms = 30.0);
+
+    const char *name() const { return "two-phase"; }
+    bool solve(const CubeState &state, MoveSequence &solution, std::string *error = NULL) const;
+
+    void setTargetLength(int length) { target_length = length; }
+    void setTimeout(double ms) { timeout_ms = ms; }
+
+private:
+    int target_length;
+    double timeout_ms;
+};
+
+#endif // TWO_PHASE_SOLVER_H
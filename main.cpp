@@ -2,10 +2,16 @@
 #include "Angel.h"
 #include "RubiksCube.h"
 #include "Cubie.h"
+#include "Log.h"
+#include "TwoPhaseSolver.h"
+#include "PocketCube.h"
+#include "ReductionSolver.h"
+#include "BackgroundSolver.h"
 #include <vector>
 #include <algorithm>
 #include <ctime>
 #include <cmath>
+#include <cstddef>
 
 // Vertices of a unit cube centered at origin
 point4 vertices[8] = {
@@ -29,12 +35,37 @@ const int face_indices[6][4] = {
     {4, 5, 6, 7}   // back face (-Z)
 };
 
+// Mesh vertex, 8 bytes: a corner of the unit cube in normalized 16-bit
+// coordinates (+-1, halved by the shader) and the face it belongs to
+struct PackedVertex {
+    GLshort x, y, z;
+    GLubyte face;
+    GLubyte pad;
+};
+
 // Global variables
 RubiksCube rubiksCube;
 
-// Vertex data for rendering
-std::vector<point4> points;
-std::vector<color4> colors;
+// Solving runs on a worker thread; created in init()
+TwoPhaseSolver* solver = NULL;
+PocketSolver* pocket_solver = NULL;
+ReductionSolver* reduction_solver = NULL;
+BackgroundSolver* background_solver = NULL;
+bool solve_wanted = false;
+
+// Vertex data for rendering: one unit cube shared by every cubie, uploaded
+// once and drawn instanced with a model matrix and grid cell per cubie.
+// Both stay put for a cube size, since cubies keep their grid slot; the
+// animating slice is turned by the vertex shader. Sticker colours are
+// PALETTE indices in a texture buffer, one byte per cubie face, that moves
+// patch in place.
+std::vector<PackedVertex> mesh_vertices;  // four per face
+std::vector<GLushort> mesh_indices;       // two triangles per face
+std::vector<mat4> instance_models;        // transposed for the attribute
+std::vector<GLbyte> instance_cells;       // x, y, z layer of each cubie
+std::vector<uint8_t> sticker_colors;      // 6 per cubie, as last uploaded
+const uint8_t STICKER_HIDDEN = 255;       // inner faces: not drawn
+const size_t STICKER_MERGE_GAP = 16;      // unchanged bytes worth uploading to save a call
 
 // Camera control
 float cam_distance = 4.0f;
@@ -44,18 +75,27 @@ double last_x = 0.0, last_y = 0.0;
 bool mouse_dragging = false;
 bool is_rotating_view = false;
 
-// Shader uniforms
-GLuint ModelView, Projection;
+// Shader program and uniforms
+GLuint program;
+GLuint View, Projection;
+GLuint SliceAxis, SliceLayer, SliceDirection, SliceAngle, SliceCenter;
 
 // Vertex buffer and array objects
 GLuint vao;
-GLuint buffer;
+GLuint buffer;                        // the cube mesh
+GLuint index_buffer;                  // and its triangles
+GLuint model_buffer;                  // per-cubie model matrices
+GLuint cell_buffer;                   // and grid cells
+GLuint sticker_buffer;                // sticker colours, seen through sticker_texture
+GLuint sticker_texture;
 
 // Global variables for mouse control
 bool shift_pressed = false;
 bool drag_started = false;
 int drag_face = -1;
 int drag_layer = 0;
+vec3 drag_point;                      // where the drag started on the cube
+int key_depth = 1;                    // layer the next face key turns, 1 = outer
 double drag_start_x = 0.0, drag_start_y = 0.0;
 const double DRAG_THRESHOLD = 30.0;  // Pixels to trigger a drag rotation
 
@@ -69,61 +109,78 @@ void printHelp();
 bool is_point_on_cube(double x, double y);
 std::pair<int, int> pick_face(double mouse_x, double mouse_y, bool force_selection = false);
 
-// Create vertices and colors for a single cubie
-void generate_cubie_geometry(const Cubie& cubie, std::vector<point4>& out_points, std::vector<color4>& out_colors) {
-    // For each face
+// The shared unit cube: a quad of four vertices for each face, drawn as
+// two indexed triangles
+void generate_cube_mesh() {
+    mesh_vertices.clear();
+    mesh_indices.clear();
     for (int face = 0; face < 6; face++) {
-        // Skip invisible faces (inner faces)
-        if (!cubie.visible[face]) continue;
-        
-        // Create two triangles for this face
-        int a = face_indices[face][0];
-        int b = face_indices[face][1];
-        int c = face_indices[face][2];
-        int d = face_indices[face][3];
-        
-        // Triangle 1
-        out_points.push_back(vertices[a]);
-        out_points.push_back(vertices[b]);
-        out_points.push_back(vertices[c]);
-        
-        out_colors.push_back(cubie.colors[face]);
-        out_colors.push_back(cubie.colors[face]);
-        out_colors.push_back(cubie.colors[face]);
-        
-        // Triangle 2
-        out_points.push_back(vertices[a]);
-        out_points.push_back(vertices[c]);
-        out_points.push_back(vertices[d]);
+        GLushort base = GLushort(mesh_vertices.size());
+        for (int k = 0; k < 4; k++) {
+            const point4& p = vertices[face_indices[face][k]];
+            PackedVertex v = {GLshort(p.x > 0 ? 32767 : -32767), GLshort(p.y > 0 ? 32767 : -32767),
+                              GLshort(p.z > 0 ? 32767 : -32767), GLubyte(face), 0};
+            mesh_vertices.push_back(v);
+        }
         
-        out_colors.push_back(cubie.colors[face]);
-        out_colors.push_back(cubie.colors[face]);
-        out_colors.push_back(cubie.colors[face]);
+        GLushort quad[6] = {0, 1, 2, 0, 2, 3};
+        for (int k = 0; k < 6; k++) mesh_indices.push_back(GLushort(base + quad[k]));
     }
 }
 
-// Regenerate all geometry
-void regenerate_geometry() {
-    points.clear();
-    colors.clear();
-    
-    // Generate geometry for each cubie
-    for (const Cubie& cubie : rubiksCube.getCubies()) {
-        generate_cubie_geometry(cubie, points, colors);
-    }
-    
-    // Update the buffer
-    glBindBuffer(GL_ARRAY_BUFFER, buffer);
-    glBufferData(GL_ARRAY_BUFFER, 
-                 points.size() * sizeof(point4) + colors.size() * sizeof(color4), 
-                 NULL, 
-                 GL_STATIC_DRAW);
+// Bring the sticker buffer up to date with the cube. After a move only
+// the runs of stickers that changed are written, a few dozen bytes for a
+// 3x3 turn; a new cube size reallocates it.
+void upload_stickers() {
+    const std::vector<Cubie>& cubies = rubiksCube.getCubies();
+    glBindBuffer(GL_TEXTURE_BUFFER, sticker_buffer);
     
-    glBufferSubData(GL_ARRAY_BUFFER, 0, 
-                   points.size() * sizeof(point4), points.data());
+    if (sticker_colors.size() != cubies.size() * 6) {
+        sticker_colors.resize(cubies.size() * 6);
+        for (size_t i = 0; i < cubies.size(); i++)
+            for (int face = 0; face < 6; face++)
+                sticker_colors[i * 6 + face] = cubies[i].visible[face] ? cubies[i].colors[face] : STICKER_HIDDEN;
+        glBufferData(GL_TEXTURE_BUFFER, sticker_colors.size(), sticker_colors.data(), GL_DYNAMIC_DRAW);
+        return;
+    }
     
-    glBufferSubData(GL_ARRAY_BUFFER, points.size() * sizeof(point4), 
-                   colors.size() * sizeof(color4), colors.data());
+    size_t run_start = 0, run_end = 0;  // pending run [start, end), empty when equal
+    for (size_t i = 0; i < cubies.size(); i++) {
+        for (int face = 0; face < 6; face++) {
+            size_t k = i * 6 + face;
+            uint8_t color = cubies[i].visible[face] ? cubies[i].colors[face] : STICKER_HIDDEN;
+            if (color == sticker_colors[k]) continue;
+            sticker_colors[k] = color;
+            
+            if (run_end > run_start && k - run_end > STICKER_MERGE_GAP) {
+                glBufferSubData(GL_TEXTURE_BUFFER, run_start, run_end - run_start, &sticker_colors[run_start]);
+                run_start = run_end;
+            }
+            if (run_end == run_start) run_start = k;
+            run_end = k + 1;
+        }
+    }
+    if (run_end > run_start)
+        glBufferSubData(GL_TEXTURE_BUFFER, run_start, run_end - run_start, &sticker_colors[run_start]);
+}
+
+// Model matrices and grid cells of the cubies, for a new cube size
+void upload_instances() {
+    const std::vector<Cubie>& cubies = rubiksCube.getCubies();
+    const std::vector<mat4>& transforms = rubiksCube.getTransforms();
+    instance_models.resize(transforms.size());
+    instance_cells.resize(cubies.size() * 3);
+    for (size_t i = 0; i < cubies.size(); i++) {
+        // Attribute matrices are read column by column
+        instance_models[i] = transpose(transforms[i]);
+        instance_cells[i * 3 + 0] = GLbyte(cubies[i].x);
+        instance_cells[i * 3 + 1] = GLbyte(cubies[i].y);
+        instance_cells[i * 3 + 2] = GLbyte(cubies[i].z);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, model_buffer);
+    glBufferData(GL_ARRAY_BUFFER, instance_models.size() * sizeof(mat4), instance_models.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, cell_buffer);
+    glBufferData(GL_ARRAY_BUFFER, instance_cells.size(), instance_cells.data(), GL_STATIC_DRAW);
 }
 
 // Initialize OpenGL state
@@ -131,48 +188,81 @@ void init() {
     // Initialize the Rubik's cube
     rubiksCube.initialize();
     
-    // Generate initial geometry
-    regenerate_geometry();
+    // Solver tables are mapped from the table file when there is one
+    solver = new TwoPhaseSolver();
+    pocket_solver = new PocketSolver();
+    reduction_solver = new ReductionSolver();
+    background_solver = new BackgroundSolver(*solver);
     
     // Load shaders
-    GLuint program = InitShader("vshader.glsl", "fshader.glsl");
+    program = InitShader("vshader.glsl", "fshader.glsl");
     glUseProgram(program);
     
-    // Create vertex array and buffer
+    // Create vertex array and buffers
     glGenVertexArrays(1, &vao);
     glGenBuffers(1, &buffer);
+    glGenBuffers(1, &index_buffer);
+    glGenBuffers(1, &model_buffer);
+    glGenBuffers(1, &cell_buffer);
     
     // Bind vertex array
     glBindVertexArray(vao);
     
-    // Bind buffer and upload vertex data
+    // The mesh is uploaded once: packed vertices and their indices
+    generate_cube_mesh();
     glBindBuffer(GL_ARRAY_BUFFER, buffer);
-    glBufferData(GL_ARRAY_BUFFER, 
-                 points.size() * sizeof(point4) + colors.size() * sizeof(color4), 
-                 NULL, 
+    glBufferData(GL_ARRAY_BUFFER, mesh_vertices.size() * sizeof(PackedVertex), mesh_vertices.data(),
+                 GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh_indices.size() * sizeof(GLushort), mesh_indices.data(),
                  GL_STATIC_DRAW);
     
-    // Upload points
-    glBufferSubData(GL_ARRAY_BUFFER, 0, 
-                   points.size() * sizeof(point4), points.data());
-    
-    // Upload colors
-    glBufferSubData(GL_ARRAY_BUFFER, points.size() * sizeof(point4), 
-                   colors.size() * sizeof(color4), colors.data());
-    
-    // Set up vertex attributes
+    // Set up vertex attributes; the face is read as an integer
     GLuint vPosition = glGetAttribLocation(program, "vPosition");
     glEnableVertexAttribArray(vPosition);
-    glVertexAttribPointer(vPosition, 4, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(0));
+    glVertexAttribPointer(vPosition, 3, GL_SHORT, GL_TRUE, sizeof(PackedVertex), BUFFER_OFFSET(0));
+    
+    GLuint vFace = glGetAttribLocation(program, "vFace");
+    glEnableVertexAttribArray(vFace);
+    glVertexAttribIPointer(vFace, 1, GL_UNSIGNED_BYTE, sizeof(PackedVertex),
+                           BUFFER_OFFSET(offsetof(PackedVertex, face)));
+    
+    // Per-instance model matrix: a mat4 takes four locations, one per column
+    glBindBuffer(GL_ARRAY_BUFFER, model_buffer);
+    GLuint vModel = glGetAttribLocation(program, "vModel");
+    for (int k = 0; k < 4; k++) {
+        glEnableVertexAttribArray(vModel + k);
+        glVertexAttribPointer(vModel + k, 4, GL_FLOAT, GL_FALSE, sizeof(mat4), BUFFER_OFFSET(k * sizeof(vec4)));
+        glVertexAttribDivisor(vModel + k, 1);
+    }
+    
+    // Per-instance grid cell, so the shader can tell which cubies turn
+    glBindBuffer(GL_ARRAY_BUFFER, cell_buffer);
+    GLuint vCell = glGetAttribLocation(program, "vCell");
+    glEnableVertexAttribArray(vCell);
+    glVertexAttribIPointer(vCell, 3, GL_BYTE, 3, BUFFER_OFFSET(0));
+    glVertexAttribDivisor(vCell, 1);
+    upload_instances();
     
-    GLuint vColor = glGetAttribLocation(program, "vColor");
-    glEnableVertexAttribArray(vColor);
-    glVertexAttribPointer(vColor, 4, GL_FLOAT, GL_FALSE, 0, 
-                         BUFFER_OFFSET(points.size() * sizeof(point4)));
+    // Sticker colours: bytes read by texelFetch in the vertex shader, and
+    // the palette they index
+    glGenBuffers(1, &sticker_buffer);
+    glGenTextures(1, &sticker_texture);
+    upload_stickers();
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, sticker_texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R8UI, sticker_buffer);
+    glUniform1i(glGetUniformLocation(program, "Stickers"), 0);
+    glUniform4fv(glGetUniformLocation(program, "Palette"), PALETTE_SIZE, PALETTE[0]);
     
     // Get uniform locations
-    ModelView = glGetUniformLocation(program, "ModelView");
+    View = glGetUniformLocation(program, "View");
     Projection = glGetUniformLocation(program, "Projection");
+    SliceAxis = glGetUniformLocation(program, "SliceAxis");
+    SliceLayer = glGetUniformLocation(program, "SliceLayer");
+    SliceDirection = glGetUniformLocation(program, "SliceDirection");
+    SliceAngle = glGetUniformLocation(program, "SliceAngle");
+    SliceCenter = glGetUniformLocation(program, "SliceCenter");
     
     // Set projection matrix
     mat4 projection = Perspective(45.0, 1.0, 0.1, 100.0);
@@ -193,33 +283,33 @@ bool is_point_on_cube(double x, double y) {
     float ndc_x = (2.0f * x) / width - 1.0f;
     float ndc_y = 1.0f - (2.0f * y) / height;
     
-    printf("NDC coordinates: (%.2f, %.2f)\n", ndc_x, ndc_y);
+    LOG_TRACE("NDC coordinates: (%.2f, %.2f)", ndc_x, ndc_y);
     
     // Increase detection radius to make it easier to click on the cube
     const float radius = 0.9f; // Increased from 0.7f
     float dist_squared = ndc_x * ndc_x + ndc_y * ndc_y;
     
-    printf("Distance squared from center: %.2f (threshold: %.2f)\n", 
-           dist_squared, radius * radius);
+    LOG_TRACE("Distance squared from center: %.2f (threshold: %.2f)", 
+              dist_squared, radius * radius);
     
     return dist_squared < (radius * radius);
 }
 
-// Ray-cube intersection for better face picking
+// Ray-cube intersection for better face picking; a scale above 1 tests
+// against an enlarged box, for more forgiving clicks
 bool ray_cube_intersection(const vec3& ray_origin, const vec3& ray_dir, 
-                          vec3& intersection_point, int& face_hit, bool force_selection = false) {
+                          vec3& intersection_point, int& face_hit, bool force_selection = false,
+                          float scale = 1.5f) {
     // Cube bounds (considering all cubies and spacing)
-    float cube_size = 3.0f * CUBE_SIZE + 2.0f * CUBE_GAP;
-    // Increase cube size for more forgiving intersection testing
-    cube_size *= 1.5f;  // Make the cube 50% larger for intersection purposes
+    float cube_size = rubiksCube.getWidth() * scale;
     
     float min_bound = -cube_size/2.0f;
     float max_bound = cube_size/2.0f;
     
-    printf("Ray origin: (%.2f, %.2f, %.2f), direction: (%.2f, %.2f, %.2f)\n", 
-           ray_origin.x, ray_origin.y, ray_origin.z, 
-           ray_dir.x, ray_dir.y, ray_dir.z);
-    printf("Cube bounds: min=%.2f, max=%.2f\n", min_bound, max_bound);
+    LOG_TRACE("Ray origin: (%.2f, %.2f, %.2f), direction: (%.2f, %.2f, %.2f)", 
+              ray_origin.x, ray_origin.y, ray_origin.z, 
+              ray_dir.x, ray_dir.y, ray_dir.z);
+    LOG_TRACE("Cube bounds: min=%.2f, max=%.2f", min_bound, max_bound);
     
     // Ray-box intersection test
     float t_min = INFINITY;
@@ -233,7 +323,7 @@ bool ray_cube_intersection(const vec3& ray_origin, const vec3& ray_dir,
             vec3 p = ray_origin + t * ray_dir;
             if (p.y >= min_bound && p.y <= max_bound && 
                 p.z >= min_bound && p.z <= max_bound) {
-                printf("Hit RIGHT face at (%.2f, %.2f, %.2f), t=%.2f\n", p.x, p.y, p.z, t);
+                LOG_TRACE("Hit RIGHT face at (%.2f, %.2f, %.2f), t=%.2f", p.x, p.y, p.z, t);
                 if (t < t_min) {
                     t_min = t;
                     hit_face = RIGHT;
@@ -250,7 +340,7 @@ bool ray_cube_intersection(const vec3& ray_origin, const vec3& ray_dir,
             vec3 p = ray_origin + t * ray_dir;
             if (p.y >= min_bound && p.y <= max_bound && 
                 p.z >= min_bound && p.z <= max_bound) {
-                printf("Hit LEFT face at (%.2f, %.2f, %.2f), t=%.2f\n", p.x, p.y, p.z, t);
+                LOG_TRACE("Hit LEFT face at (%.2f, %.2f, %.2f), t=%.2f", p.x, p.y, p.z, t);
                 if (t < t_min) {
                     t_min = t;
                     hit_face = LEFT;
@@ -267,7 +357,7 @@ bool ray_cube_intersection(const vec3& ray_origin, const vec3& ray_dir,
             vec3 p = ray_origin + t * ray_dir;
             if (p.x >= min_bound && p.x <= max_bound && 
                 p.z >= min_bound && p.z <= max_bound) {
-                printf("Hit TOP face at (%.2f, %.2f, %.2f), t=%.2f\n", p.x, p.y, p.z, t);
+                LOG_TRACE("Hit TOP face at (%.2f, %.2f, %.2f), t=%.2f", p.x, p.y, p.z, t);
                 if (t < t_min) {
                     t_min = t;
                     hit_face = TOP;
@@ -284,7 +374,7 @@ bool ray_cube_intersection(const vec3& ray_origin, const vec3& ray_dir,
             vec3 p = ray_origin + t * ray_dir;
             if (p.x >= min_bound && p.x <= max_bound && 
                 p.z >= min_bound && p.z <= max_bound) {
-                printf("Hit BOTTOM face at (%.2f, %.2f, %.2f), t=%.2f\n", p.x, p.y, p.z, t);
+                LOG_TRACE("Hit BOTTOM face at (%.2f, %.2f, %.2f), t=%.2f", p.x, p.y, p.z, t);
                 if (t < t_min) {
                     t_min = t;
                     hit_face = BOTTOM;
@@ -301,7 +391,7 @@ bool ray_cube_intersection(const vec3& ray_origin, const vec3& ray_dir,
             vec3 p = ray_origin + t * ray_dir;
             if (p.x >= min_bound && p.x <= max_bound && 
                 p.y >= min_bound && p.y <= max_bound) {
-                printf("Hit FRONT face at (%.2f, %.2f, %.2f), t=%.2f\n", p.x, p.y, p.z, t);
+                LOG_TRACE("Hit FRONT face at (%.2f, %.2f, %.2f), t=%.2f", p.x, p.y, p.z, t);
                 if (t < t_min) {
                     t_min = t;
                     hit_face = FRONT;
@@ -318,7 +408,7 @@ bool ray_cube_intersection(const vec3& ray_origin, const vec3& ray_dir,
             vec3 p = ray_origin + t * ray_dir;
             if (p.x >= min_bound && p.x <= max_bound && 
                 p.y >= min_bound && p.y <= max_bound) {
-                printf("Hit BACK face at (%.2f, %.2f, %.2f), t=%.2f\n", p.x, p.y, p.z, t);
+                LOG_TRACE("Hit BACK face at (%.2f, %.2f, %.2f), t=%.2f", p.x, p.y, p.z, t);
                 if (t < t_min) {
                     t_min = t;
                     hit_face = BACK;
@@ -330,8 +420,8 @@ bool ray_cube_intersection(const vec3& ray_origin, const vec3& ray_dir,
     
     if (hit_face != -1) {
         face_hit = hit_face;
-        printf("Final hit face: %d at point (%.2f, %.2f, %.2f)\n", 
-               hit_face, intersection_point.x, intersection_point.y, intersection_point.z);
+        LOG_TRACE("Final hit face: %d at point (%.2f, %.2f, %.2f)", 
+                  hit_face, intersection_point.x, intersection_point.y, intersection_point.z);
         return true;
     }
     
@@ -374,15 +464,27 @@ bool ray_cube_intersection(const vec3& ray_origin, const vec3& ray_dir,
                 case BACK: intersection_point = vec3(0, 0, min_bound); break;
             }
             
-            printf("Forced selection: face %d with dot product %.2f\n", best_face, max_dot);
+            LOG_TRACE("Forced selection: face %d with dot product %.2f", best_face, max_dot);
             return true;
         }
     }
     
-    printf("No face intersection found\n");
+    LOG_TRACE("No face intersection found");
     return false;
 }
 
+// Camera position and its right/up directions in world space
+void camera_frame(vec3& eye, vec3& right, vec3& up) {
+    float cam_x = cam_distance * sin(cam_theta) * cos(cam_phi);
+    float cam_y = cam_distance * sin(cam_phi);
+    float cam_z = cam_distance * cos(cam_theta) * cos(cam_phi);
+    
+    eye = vec3(cam_x, cam_y, cam_z);
+    vec3 forward = normalize(vec3(0, 0, 0) - eye);
+    right = normalize(cross(vec3(0, 1, 0), forward));
+    up = cross(forward, right);
+}
+
 // Convert mouse coordinates to a ray in world space
 void mouse_to_ray(double mouse_x, double mouse_y, vec3& ray_origin, vec3& ray_dir) {
     // Get current window size
@@ -393,18 +495,10 @@ void mouse_to_ray(double mouse_x, double mouse_y, vec3& ray_origin, vec3& ray_di
     float ndc_x = (2.0f * mouse_x) / width - 1.0f;
     float ndc_y = 1.0f - (2.0f * mouse_y) / height;
     
-    // Calculate camera position
-    float cam_x = cam_distance * sin(cam_theta) * cos(cam_phi);
-    float cam_y = cam_distance * sin(cam_phi);
-    float cam_z = cam_distance * cos(cam_theta) * cos(cam_phi);
-    
-    ray_origin = vec3(cam_x, cam_y, cam_z);
-    
     // Calculate ray direction (simplified)
-    vec3 at(0, 0, 0);
-    vec3 forward = normalize(at - ray_origin);
-    vec3 right = normalize(cross(vec3(0, 1, 0), forward));
-    vec3 up = cross(forward, right);
+    vec3 right, up;
+    camera_frame(ray_origin, right, up);
+    vec3 forward = normalize(vec3(0, 0, 0) - ray_origin);
     
     // Field of view factor (adjust based on your perspective settings)
     float fov_factor = tan(DegreesToRadians * 45.0f / 2.0f);
@@ -429,37 +523,20 @@ std::pair<int, int> pick_face(double mouse_x, double mouse_y, bool force_selecti
     int face_hit;
     
     if (ray_cube_intersection(ray_origin, ray_dir, intersection_point, face_hit, force_selection)) {
-        // Determine layer based on intersection point
-        float spacing = CUBE_SIZE + CUBE_GAP;
-        float cube_size = 3.0f * CUBE_SIZE + 2.0f * CUBE_GAP;
-        float min_bound = -cube_size/2.0f;
-        float max_bound = cube_size/2.0f;
-        
-        // Convert intersection point to cubie coordinates
-        int layer;
-        
-        switch (face_hit) {
-            case RIGHT:
-                layer = 1;  // Outer layer
-                break;
-            case LEFT:
-                layer = -1;  // Outer layer
-                break;
-            case TOP:
-                layer = 1;  // Outer layer
-                break;
-            case BOTTOM:
-                layer = -1;  // Outer layer
-                break;
-            case FRONT:
-                layer = 1;  // Outer layer
-                break;
-            case BACK:
-                layer = -1;  // Outer layer
-                break;
-            default:
-                layer = 0;
+        // Clicks turn the face itself; drags use the point to find the slice.
+        // The enlarged box only decides whether the click counts: the point
+        // is where the ray meets the real cube, or the nearest point of it
+        // for clicks in the margin
+        vec3 cube_point;
+        int cube_face;
+        if (ray_cube_intersection(ray_origin, ray_dir, cube_point, cube_face, false, 1.0f)) {
+            drag_point = cube_point;
+            face_hit = cube_face;
+        } else {
+            float half = rubiksCube.getWidth() / 2.0f;
+            for (int k = 0; k < 3; k++) drag_point[k] = std::max(-half, std::min(intersection_point[k], half));
         }
+        int layer = rubiksCube.layerFromFace(face_hit, 1);
         
         return std::make_pair(face_hit, layer);
     }
@@ -483,124 +560,121 @@ void display() {
     
     mat4 view = LookAt(eye, at, up);
     
-    // Calculate vertices per cubie
-    std::vector<int> vertices_per_cubie;
-    std::vector<int> start_indices;
-    
-    int start_idx = 0;
-    for (const Cubie& cubie : rubiksCube.getCubies()) {
-        int count = 0;
-        for (int face = 0; face < 6; face++) {
-            if (cubie.visible[face]) {
-                count += 6; // 2 triangles * 3 vertices
-            }
-        }
+    // The animating slice, turned by the vertex shader: the cubies whose
+    // cell is on the layer rotate about the axis through the slice centre,
+    // so the per-frame cost is the same however many of them move
+    if (rubiksCube.isAnimating()) {
+        int axis = rubiksCube.getRotatingFace() / 2;
+        vec3 center(0.0f);
+        center[axis] = rubiksCube.layerCenter(rubiksCube.getRotatingLayer());
         
-        vertices_per_cubie.push_back(count);
-        start_indices.push_back(start_idx);
-        start_idx += count;
+        glUniform1i(SliceAxis, axis);
+        glUniform1i(SliceLayer, rubiksCube.getRotatingLayer());
+        glUniform3fv(SliceDirection, 1, rubiksCube.getRotationAxis());
+        glUniform1f(SliceAngle, rubiksCube.getRotationAngle());
+        glUniform3fv(SliceCenter, 1, center);
+    } else {
+        glUniform1i(SliceAxis, -1);
     }
     
-    // Draw each cubie
-    const std::vector<mat4>& transforms = rubiksCube.getTransforms();
-    for (int i = 0; i < rubiksCube.getCubies().size(); i++) {
-        const Cubie& cubie = rubiksCube.getCubies()[i];
-        
-        // Skip if no visible faces
-        if (vertices_per_cubie[i] == 0) continue;
-        
-        // Start with the cubie's transformation
-        mat4 model = transforms[i];
-        
-        // Apply rotation animation if this cubie is on the rotating face
-        if (rubiksCube.isAnimating()) {
-            int rotating_face = rubiksCube.getRotatingFace();
-            int rotating_layer = rubiksCube.getRotatingLayer();
-            float rotation_angle = rubiksCube.getRotationAngle();
-            vec3 rotation_axis = rubiksCube.getRotationAxis();
-            
-            std::vector<int> face_indices = rubiksCube.getFaceCubies(rotating_face, rotating_layer);
-            
-            // Check if this cubie is on the rotating face
-            if (std::find(face_indices.begin(), face_indices.end(), i) != face_indices.end()) {
-                // Calculate rotation center based on face
-                vec3 center(0.0f);
-                float spacing = CUBE_SIZE + CUBE_GAP;
-                
-                // Set center based on the face and layer
-                if (rotating_face == RIGHT || rotating_face == LEFT) {
-                    center.x = rotating_layer * spacing;
-                } else if (rotating_face == TOP || rotating_face == BOTTOM) {
-                    center.y = rotating_layer * spacing;
-                } else { // FRONT or BACK
-                    center.z = rotating_layer * spacing;
-                }
-                
-                // Apply rotation around the center
-                mat4 T1 = Translate(-center);
-                mat4 R;
-                
-                if (rotation_axis.x != 0.0f)
-                    R = RotateX(rotation_angle * (rotation_axis.x > 0 ? 1 : -1));
-                else if (rotation_axis.y != 0.0f)
-                    R = RotateY(rotation_angle * (rotation_axis.y > 0 ? 1 : -1));
-                else
-                    R = RotateZ(rotation_angle * (rotation_axis.z > 0 ? 1 : -1));
-                
-                mat4 T2 = Translate(center);
-                
-                model = T2 * R * T1 * model;
+    glUniformMatrix4fv(View, 1, GL_TRUE, view);
+    // The whole cube is a single instanced draw
+    glDrawElementsInstanced(GL_TRIANGLES, mesh_indices.size(), GL_UNSIGNED_SHORT, BUFFER_OFFSET(0),
+                            instance_models.size());
+}
+
+// Update animation and handle changes that need to be made to the display
+// Hand the cube to the background solver once it is at rest, and queue the
+// solution if the cube has not been touched since the snapshot; otherwise
+// drop it and solve the new state
+void update_solver() {
+    if (!solve_wanted) return;
+    if (rubiksCube.getSize() > REDUCTION_MAX_SIZE) {
+        LOG_WARN("No solver for the %dx%dx%d cube", rubiksCube.getSize(), rubiksCube.getSize(), rubiksCube.getSize());
+        solve_wanted = false;
+        return;
+    }
+    
+    SolveResult result;
+    if (background_solver->poll(result)) {
+        if (result.version == rubiksCube.getStateVersion() && rubiksCube.isIdle()) {
+            solve_wanted = false;
+            if (!result.ok) {
+                LOG_WARN("Cannot solve: %s", result.error.c_str());
+            } else if (result.solution.empty() && result.big_solution.empty()) {
+                LOG_INFO("Already solved");
+            } else if (!result.big_solution.empty()) {
+                LOG_INFO("Solved in %zu moves (%.1f ms)", result.big_solution.size(), result.seconds * 1000.0);
+                rubiksCube.queueBigMoves(result.big_solution);
+            } else {
+                LOG_INFO("Solved in %zu moves (%.1f ms): %s", result.solution.size(),
+                         result.seconds * 1000.0, result.solution.toString().c_str());
+                rubiksCube.queueSequence(result.solution, false);
             }
+            return;
         }
-        
-        // Apply view transform and send to shader
-        mat4 model_view = view * model;
-        glUniformMatrix4fv(ModelView, 1, GL_TRUE, model_view);
-        
-        // Draw this cubie
-        glDrawArrays(GL_TRIANGLES, start_indices[i], vertices_per_cubie[i]);
+        LOG_DEBUG("Cube changed while solving; discarding the solution");
     }
+    
+    unsigned version = rubiksCube.getStateVersion();
+    if (!rubiksCube.isIdle() || background_solver->isSolving(version)) return;
+    if (rubiksCube.getSize() > 3)
+        background_solver->request(rubiksCube.getBigCube(), version, *reduction_solver);
+    else
+        background_solver->request(rubiksCube.getState(), version, rubiksCube.getSize() == 2 ? pocket_solver : NULL);
 }
 
-// Update animation and handle changes that need to be made to the display
 void update() {
-    // Update cube animation
-    if (rubiksCube.isAnimating()) {
-        // Update animation
-        rubiksCube.updateAnimation();
-        
-        // Regenerate geometry if animation completed
-        if (!rubiksCube.isAnimating()) {
-            regenerate_geometry();
-        }
+    static unsigned drawn_version = rubiksCube.getStateVersion();
+    
+    // Update cube animation (also starts moves queued by other threads)
+    rubiksCube.updateAnimation();
+    update_solver();
+    
+    // Patch the sticker colours whenever a move has been applied
+    if (rubiksCube.getStateVersion() != drawn_version) {
+        drawn_version = rubiksCube.getStateVersion();
+        upload_stickers();
     }
 }
 
 // Print help information
 void printHelp() {
-    printf("\n===== Rubik's Cube Controls =====\n");
-    printf("Mouse:\n");
-    printf("  Left Drag: Rotate a slice (≈30px to trigger)\n");
-    printf("  Left Click: Rotate face clockwise\n");
-    printf("  Shift+Left Click: Rotate face counter-clockwise\n");
-    printf("  Right Drag: Orbit camera\n");
-    printf("  Mouse Wheel: Zoom in/out\n");
-    printf("Keyboard:\n");
-    printf("  R/r: Right face CW/CCW\n");
-    printf("  L/l: Left face CW/CCW\n");
-    printf("  U/u: Upper face CW/CCW\n");
-    printf("  D/d: Down face CW/CCW\n");
-    printf("  F/f: Front face CW/CCW\n");
-    printf("  B/b: Back face CW/CCW\n");
-    printf("  M/m: Middle slice (X) CW/CCW\n");
-    printf("  E/e: Middle slice (Y) CW/CCW\n");
-    printf("  S/s: Middle slice (Z) CW/CCW\n");
-    printf("  +/-: Zoom in/out\n");
-    printf("  S: Shuffle (20 random moves)\n");
-    printf("  C: Reset cube\n");
-    printf("  H: Show this help message\n");
-    printf("  ESC or Q: Exit the program\n");
-    printf("================================\n\n");
+    LOG_INFO("===== Rubik's Cube Controls =====");
+    LOG_INFO("Mouse:");
+    LOG_INFO("  Left Drag: Rotate a slice (≈30px to trigger)");
+    LOG_INFO("  Left Click: Rotate face clockwise");
+    LOG_INFO("  Shift+Left Click: Rotate face counter-clockwise");
+    LOG_INFO("  Right Drag: Orbit camera");
+    LOG_INFO("  Mouse Wheel: Zoom in/out");
+    LOG_INFO("Keyboard:");
+    LOG_INFO("  R/r: Right face CW/CCW");
+    LOG_INFO("  L/l: Left face CW/CCW");
+    LOG_INFO("  U/u: Upper face CW/CCW");
+    LOG_INFO("  D/d: Down face CW/CCW");
+    LOG_INFO("  F/f: Front face CW/CCW");
+    LOG_INFO("  B/b: Back face CW/CCW");
+    LOG_INFO("  M/m: Middle slice (X) CW/CCW");
+    LOG_INFO("  E/e: Middle slice (Y) CW/CCW");
+    LOG_INFO("  S/s: Middle slice (Z) CW/CCW");
+    LOG_INFO("  1-9 then a face key: Turn that layer counted in from the face");
+    LOG_INFO("  +/-: Zoom in/out");
+    LOG_INFO("  S: Shuffle (20 random moves)");
+    LOG_INFO("  Enter: Solve (up to %dx%dx%d)", REDUCTION_MAX_SIZE, REDUCTION_MAX_SIZE, REDUCTION_MAX_SIZE);
+    LOG_INFO("  C: Reset cube");
+    LOG_INFO("  [ / ]: Smaller / larger cube (%dx%dx%d .. %dx%dx%d)", MIN_CUBE_SIZE, MIN_CUBE_SIZE, MIN_CUBE_SIZE,
+             MAX_CUBE_SIZE, MAX_CUBE_SIZE, MAX_CUBE_SIZE);
+    LOG_INFO("  H: Show this help message");
+    LOG_INFO("  ESC or Q: Exit the program");
+    LOG_INFO("================================");
+}
+
+// Layer turned by a face key: the one picked with the digit keys, counted
+// in from that face, then back to the face itself
+int key_layer(int face) {
+    int layer = rubiksCube.layerFromFace(face, key_depth);
+    key_depth = 1;
+    return layer;
 }
 
 // Key callback
@@ -614,42 +688,48 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
             case GLFW_KEY_H:
                 printHelp();
                 break;
+            // Layer depth for the next face key
+            case GLFW_KEY_1: case GLFW_KEY_2: case GLFW_KEY_3:
+            case GLFW_KEY_4: case GLFW_KEY_5: case GLFW_KEY_6:
+            case GLFW_KEY_7: case GLFW_KEY_8: case GLFW_KEY_9:
+                key_depth = key - GLFW_KEY_0;
+                break;
             // Face rotations - clockwise
             case GLFW_KEY_R:
                 if (!(mods & GLFW_MOD_SHIFT) && !rubiksCube.isAnimating())
-                    rubiksCube.startRotation(RIGHT, 1, true); // True means CW
+                    rubiksCube.startRotation(RIGHT, key_layer(RIGHT), true); // True means CW
                 else if ((mods & GLFW_MOD_SHIFT) && !rubiksCube.isAnimating())
-                    rubiksCube.startRotation(RIGHT, 1, false);  // False means CCW
+                    rubiksCube.startRotation(RIGHT, key_layer(RIGHT), false);  // False means CCW
                 break;
             case GLFW_KEY_L:
                 if (!(mods & GLFW_MOD_SHIFT) && !rubiksCube.isAnimating())
-                    rubiksCube.startRotation(LEFT, -1, true); // True means CW
+                    rubiksCube.startRotation(LEFT, key_layer(LEFT), true); // True means CW
                 else if ((mods & GLFW_MOD_SHIFT) && !rubiksCube.isAnimating())
-                    rubiksCube.startRotation(LEFT, -1, false);  // False means CCW
+                    rubiksCube.startRotation(LEFT, key_layer(LEFT), false);  // False means CCW
                 break;
             case GLFW_KEY_U:
                 if (!(mods & GLFW_MOD_SHIFT) && !rubiksCube.isAnimating())
-                    rubiksCube.startRotation(TOP, 1, true); // True means CW
+                    rubiksCube.startRotation(TOP, key_layer(TOP), true); // True means CW
                 else if ((mods & GLFW_MOD_SHIFT) && !rubiksCube.isAnimating())
-                    rubiksCube.startRotation(TOP, 1, false);  // False means CCW
+                    rubiksCube.startRotation(TOP, key_layer(TOP), false);  // False means CCW
                 break;
             case GLFW_KEY_D:
                 if (!(mods & GLFW_MOD_SHIFT) && !rubiksCube.isAnimating())
-                    rubiksCube.startRotation(BOTTOM, -1, true); // True means CW
+                    rubiksCube.startRotation(BOTTOM, key_layer(BOTTOM), true); // True means CW
                 else if ((mods & GLFW_MOD_SHIFT) && !rubiksCube.isAnimating())
-                    rubiksCube.startRotation(BOTTOM, -1, false);  // False means CCW
+                    rubiksCube.startRotation(BOTTOM, key_layer(BOTTOM), false);  // False means CCW
                 break;
             case GLFW_KEY_F:
                 if (!(mods & GLFW_MOD_SHIFT) && !rubiksCube.isAnimating())
-                    rubiksCube.startRotation(FRONT, 1, true); // True means CW
+                    rubiksCube.startRotation(FRONT, key_layer(FRONT), true); // True means CW
                 else if ((mods & GLFW_MOD_SHIFT) && !rubiksCube.isAnimating())
-                    rubiksCube.startRotation(FRONT, 1, false);  // False means CCW
+                    rubiksCube.startRotation(FRONT, key_layer(FRONT), false);  // False means CCW
                 break;
             case GLFW_KEY_B:
                 if (!(mods & GLFW_MOD_SHIFT) && !rubiksCube.isAnimating())
-                    rubiksCube.startRotation(BACK, -1, true); // True means CW
+                    rubiksCube.startRotation(BACK, key_layer(BACK), true); // True means CW
                 else if ((mods & GLFW_MOD_SHIFT) && !rubiksCube.isAnimating())
-                    rubiksCube.startRotation(BACK, -1, false);  // False means CCW
+                    rubiksCube.startRotation(BACK, key_layer(BACK), false);  // False means CCW
                 break;
             // Middle slices
             case GLFW_KEY_M:
@@ -669,18 +749,38 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
                     // Capital S for shuffle - 20 random moves
                     if (!rubiksCube.isAnimating()) {
                         rubiksCube.randomize(20);
-                        printf("Performing 20 random moves...\n");
+                        LOG_INFO("Performing 20 random moves...");
                     }
                 } else if ((mods & GLFW_MOD_SHIFT) && !rubiksCube.isAnimating()) {
                     // Shift+S for middle Z slice rotation
                     rubiksCube.startRotation(FRONT, 0, false); // False means CCW
                 }
                 break;
+            // Solve in the background; update() queues the result
+            case GLFW_KEY_ENTER:
+            case GLFW_KEY_KP_ENTER:
+                if (action == GLFW_PRESS) {
+                    solve_wanted = true;
+                    LOG_INFO("Solving...");
+                }
+                break;
             // Other controls
             case GLFW_KEY_C:  // Reset
                 rubiksCube.initialize();
-                regenerate_geometry();
+                upload_stickers();
                 break;
+            case GLFW_KEY_LEFT_BRACKET:
+            case GLFW_KEY_RIGHT_BRACKET: {
+                int size = rubiksCube.getSize() + (key == GLFW_KEY_RIGHT_BRACKET ? 1 : -1);
+                if (size >= MIN_CUBE_SIZE && size <= MAX_CUBE_SIZE) {
+                    rubiksCube.setSize(size);
+                    solve_wanted = false;
+                    key_depth = 1;
+                    upload_stickers();
+                    upload_instances();
+                }
+                break;
+            }
             case GLFW_KEY_MINUS:
             case GLFW_KEY_KP_SUBTRACT:
                 cam_distance = std::min(cam_distance + 0.4f, 10.0f);
@@ -706,11 +806,11 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
             drag_start_x = xpos;
             drag_start_y = ypos;
             
-            printf("LEFT PRESS: x=%.1f, y=%.1f, shift=%d\n", xpos, ypos, shift_pressed);
+            LOG_TRACE("LEFT PRESS: x=%.1f, y=%.1f, shift=%d", xpos, ypos, shift_pressed);
             
             // Check if click is on the cube
             bool on_cube = is_point_on_cube(xpos, ypos);
-            printf("Click is %s the cube\n", on_cube ? "ON" : "NOT ON");
+            LOG_TRACE("Click is %s the cube", on_cube ? "ON" : "NOT ON");
             
             if (on_cube) {
                 // Set drag mode for face rotation - force a face selection for left mouse button
@@ -718,22 +818,22 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
                 drag_face = pick_result.first;
                 drag_layer = pick_result.second;
                 
-                printf("Selected face: %d, layer: %d\n", drag_face, drag_layer);
+                LOG_TRACE("Selected face: %d, layer: %d", drag_face, drag_layer);
                 
                 // Only set drag_started if we have a valid face
                 if (drag_face >= 0 && drag_face < 6) {
                     drag_started = true;
                     is_rotating_view = false;  // Ensure we're not rotating the view
-                    printf("Valid face selected, preparing for rotation\n");
+                    LOG_TRACE("Valid face selected, preparing for rotation");
                 } else {
                     // Should never happen with force_selection=true
                     is_rotating_view = true;
-                    printf("No valid face selected, rotating view\n");
+                    LOG_TRACE("No valid face selected, rotating view");
                 }
             } else {
                 // Not on cube, so rotate view
                 is_rotating_view = true;
-                printf("Click not on cube, rotating view\n");
+                LOG_TRACE("Click not on cube, rotating view");
             }
             
             mouse_dragging = true;
@@ -744,20 +844,19 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
             double dy = ypos - drag_start_y;
             double distance = sqrt(dx*dx + dy*dy);
             
-            printf("LEFT RELEASE: x=%.1f, y=%.1f, distance=%.1f\n", xpos, ypos, distance);
-            printf("drag_face=%d, is_animating=%d\n", drag_face, rubiksCube.isAnimating());
+            LOG_TRACE("LEFT RELEASE: x=%.1f, y=%.1f, distance=%.1f", xpos, ypos, distance);
+            LOG_TRACE("drag_face=%d, is_animating=%d", drag_face, rubiksCube.isAnimating());
             
             // If we didn't drag much, treat as a click
             if (distance < 5.0 && is_point_on_cube(xpos, ypos) && !rubiksCube.isAnimating() && drag_face >= 0) {
                 // Standard convention: no shift = CW, shift = CCW
                 bool clockwise = !shift_pressed;
-                printf("CLICK ROTATION: face %d, layer %d, %s\n", 
-                       drag_face, drag_layer, clockwise ? "CW" : "CCW");
+                LOG_TRACE("CLICK ROTATION: face %d, layer %d, %s", 
+                          drag_face, drag_layer, clockwise ? "CW" : "CCW");
                 rubiksCube.startRotation(drag_face, drag_layer, clockwise);
-                regenerate_geometry();
             } else {
-                printf("Not triggering click rotation: distance=%.1f, on_cube=%d, animating=%d, face=%d\n",
-                       distance, is_point_on_cube(xpos, ypos), rubiksCube.isAnimating(), drag_face);
+                LOG_TRACE("Not triggering click rotation: distance=%.1f, on_cube=%d, animating=%d, face=%d",
+                          distance, is_point_on_cube(xpos, ypos), rubiksCube.isAnimating(), drag_face);
             }
             
             mouse_dragging = false;
@@ -803,71 +902,33 @@ void cursor_position_callback(GLFWwindow* window, double xpos, double ypos) {
             double dy = ypos - drag_start_y;
             double distance = sqrt(dx*dx + dy*dy);
             
-            printf("Dragging: dx=%.1f, dy=%.1f, distance=%.1f, threshold=%.1f\n", 
-                   dx, dy, distance, DRAG_THRESHOLD);
+            LOG_TRACE("Dragging: dx=%.1f, dy=%.1f, distance=%.1f, threshold=%.1f", 
+                      dx, dy, distance, DRAG_THRESHOLD);
             
             if (distance > DRAG_THRESHOLD) {
-                bool clockwise = false;
-                
-                // Determine rotation direction based on drag and face
-                switch (drag_face) {
-                    case RIGHT:
-                        // Vertical drag for right face
-                        clockwise = (dy > 0);
-                        printf("RIGHT face: dy=%.1f, clockwise=%d\n", dy, clockwise);
-                        break;
-                    case LEFT:
-                        // Vertical drag for left face
-                        clockwise = (dy < 0);
-                        printf("LEFT face: dy=%.1f, clockwise=%d\n", dy, clockwise);
-                        break;
-                    case TOP:
-                        // Horizontal drag for top face
-                        clockwise = (dx < 0);
-                        printf("TOP face: dx=%.1f, clockwise=%d\n", dx, clockwise);
-                        break;
-                    case BOTTOM:
-                        // Horizontal drag for bottom face
-                        clockwise = (dx > 0);
-                        printf("BOTTOM face: dx=%.1f, clockwise=%d\n", dx, clockwise);
-                        break;
-                    case FRONT:
-                        // Use direction of strongest drag
-                        if (fabs(dx) > fabs(dy)) {
-                            // Horizontal drag - rotate around Y axis
-                            clockwise = (dx < 0);
-                            printf("FRONT face horizontal: dx=%.1f, clockwise=%d\n", dx, clockwise);
-                        } else {
-                            // Vertical drag - rotate around X axis
-                            clockwise = (dy > 0);
-                            printf("FRONT face vertical: dy=%.1f, clockwise=%d\n", dy, clockwise);
-                        }
-                        break;
-                    case BACK:
-                        // Use direction of strongest drag
-                        if (fabs(dx) > fabs(dy)) {
-                            // Horizontal drag - rotate around Y axis
-                            clockwise = (dx > 0);
-                            printf("BACK face horizontal: dx=%.1f, clockwise=%d\n", dx, clockwise);
-                        } else {
-                            // Vertical drag - rotate around X axis
-                            clockwise = (dy < 0);
-                            printf("BACK face vertical: dy=%.1f, clockwise=%d\n", dy, clockwise);
-                        }
-                        break;
-                }
+                // Turn the slice through the picked point that carries it
+                // along the drag: the drag in world space, crossed with the
+                // face normal, is the axis of a +90 degree turn
+                vec3 eye, right, up;
+                camera_frame(eye, right, up);
+                vec3 drag = right * (float)dx - up * (float)dy;
+                vec3 axis = cross(FACE_DIR[drag_face], drag);
+                int a = 0;
+                for (int k = 1; k < 3; ++k)
+                    if (fabs(axis[k]) > fabs(axis[a])) a = k;
+                int face = a * 2 + (axis[a] < 0 ? 1 : 0);
+                int layer = rubiksCube.layerAt(drag_point[a]);
+                bool clockwise = true;
                 
                 // Apply shift modifier to invert direction if necessary
                 if (shift_pressed) {
                     clockwise = !clockwise;
-                    printf("Shift pressed, inverting rotation to: %s\n", clockwise ? "CW" : "CCW");
+                    LOG_TRACE("Shift pressed, inverting rotation to: %s", clockwise ? "CW" : "CCW");
                 }
                 
-                // Start the rotation (now using standard convention)
-                printf("Starting drag rotation: face=%d, layer=%d, %s\n", 
-                       drag_face, drag_layer, clockwise ? "CW" : "CCW");
-                rubiksCube.startRotation(drag_face, drag_layer, clockwise);
-                regenerate_geometry();
+                LOG_TRACE("Starting drag rotation: face=%d, layer=%d, %s", 
+                          face, layer, clockwise ? "CW" : "CCW");
+                rubiksCube.startRotation(face, layer, clockwise);
                 
                 // Reset drag state
                 drag_started = false;
@@ -883,7 +944,7 @@ void cursor_position_callback(GLFWwindow* window, double xpos, double ypos) {
                 
                 if (drag_face >= 0) {
                     drag_started = true;
-                    printf("Reacquired face: %d, layer: %d\n", drag_face, drag_layer);
+                    LOG_TRACE("Reacquired face: %d, layer: %d", drag_face, drag_layer);
                 }
             }
         }
@@ -911,7 +972,7 @@ int main() {
     
     // Initialize GLFW
     if (!glfwInit()) {
-        fprintf(stderr, "Failed to initialize GLFW\n");
+        LOG_ERROR("Failed to initialize GLFW");
         exit(EXIT_FAILURE);
     }
     
@@ -924,7 +985,7 @@ int main() {
     // Create window
     GLFWwindow* window = glfwCreateWindow(800, 800, "Rubik's Cube", NULL, NULL);
     if (!window) {
-        fprintf(stderr, "Failed to create GLFW window\n");
+        LOG_ERROR("Failed to create GLFW window");
         glfwTerminate();
         exit(EXIT_FAILURE);
     }
@@ -942,16 +1003,16 @@ int main() {
     glewExperimental = GL_TRUE;
     GLenum err = glewInit();
     if (err != GLEW_OK) {
-        fprintf(stderr, "GLEW initialization error: %s\n", glewGetErrorString(err));
+        LOG_ERROR("GLEW initialization error: %s", (const char *)glewGetErrorString(err));
         return 1;
     }
     #endif
     
     // Print OpenGL information
-    printf("OpenGL Version: %s\n", glGetString(GL_VERSION));
-    printf("GLSL Version: %s\n", glGetString(GL_SHADING_LANGUAGE_VERSION));
-    printf("Vendor: %s\n", glGetString(GL_VENDOR));
-    printf("Renderer: %s\n", glGetString(GL_RENDERER));
+    LOG_INFO("OpenGL Version: %s", (const char *)glGetString(GL_VERSION));
+    LOG_INFO("GLSL Version: %s", (const char *)glGetString(GL_SHADING_LANGUAGE_VERSION));
+    LOG_INFO("Vendor: %s", (const char *)glGetString(GL_VENDOR));
+    LOG_INFO("Renderer: %s", (const char *)glGetString(GL_RENDERER));
     
     // Initialize OpenGL state
     init();
@@ -976,8 +1037,18 @@ int main() {
     }
     
     // Clean up
+    delete background_solver;
+    delete solver;
+    delete pocket_solver;
+    delete reduction_solver;
     glDeleteVertexArrays(1, &vao);
     glDeleteBuffers(1, &buffer);
+    glDeleteBuffers(1, &index_buffer);
+    glDeleteBuffers(1, &model_buffer);
+    glDeleteBuffers(1, &cell_buffer);
+    glDeleteBuffers(1, &sticker_buffer);
+    glDeleteTextures(1, &sticker_texture);
+    glDeleteProgram(program);
     
     glfwTerminate();
     return 0;
@@ -0,0 +1,245 @@
+// Headless batch solver: reads one scramble per line, solves them on a
+// work-stealing pool of threads sharing one solver and its read-only
+// tables, and writes the solutions in input order as they complete.
+//
+// usage: rubik_batch [--solver two-phase|thistlethwaite|cfop|optimal|pocket] [--threads n] [file]
+//
+// Scrambles are read from file, or stdin when it is absent or "-"; blank
+// lines and lines starting with # are skipped. Each output line is
+//
+//   <solution> TAB <moves> TAB <solve time in ms>
+//
+// or "error: <reason>" in place of the solution. The totals (solves/s and
+// latency percentiles) go to stderr, along with the log.
+#include "Log.h"
+#include "TwoPhaseSolver.h"
+#include "ThistlethwaiteSolver.h"
+#include "OptimalSolver.h"
+#include "CfopSolver.h"
+#include "PocketCube.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Scrambles read but not yet written; bounds memory on unbounded input
+static const size_t WINDOW = 4096;
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+namespace {
+
+struct Job {
+    std::string scramble;
+    std::string output;
+    double ms;
+    bool done;
+};
+
+// Each worker takes from the front of its own queue and, when that is
+// empty, steals from the back of another's
+struct WorkQueue {
+    std::mutex mutex;
+    std::deque<size_t> items;
+};
+
+class BatchRunner {
+public:
+    BatchRunner(const Solver &solver, int threads)
+        : solver(solver), jobs(WINDOW), queues(threads), pending(0), read(0), written(0), eof(false) {}
+
+    void run(FILE *in, FILE *out, std::vector<double> &latencies) {
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < queues.size(); ++i) workers.push_back(std::thread(&BatchRunner::work, this, i));
+        std::thread reader(&BatchRunner::readLines, this, in);
+
+        // Write results in input order as they complete
+        for (;;) {
+            std::unique_lock<std::mutex> lock(mutex);
+            result_ready.wait(lock, [this] { return written < read ? jobs[written % WINDOW].done : eof; });
+            if (written == read) break;
+            Job &job = jobs[written % WINDOW];
+            lock.unlock();
+
+            fprintf(out, "%s\t%.3f\n", job.output.c_str(), job.ms);
+            latencies.push_back(job.ms);
+
+            lock.lock();
+            job.done = false;
+            ++written;
+            space_free.notify_one();
+        }
+
+        reader.join();
+        for (size_t i = 0; i < workers.size(); ++i) workers[i].join();
+        fflush(out);
+    }
+
+private:
+    void readLines(FILE *in) {
+        std::string line;
+        int c;
+        size_t next = 0;
+        for (;;) {
+            line.clear();
+            while ((c = fgetc(in)) != EOF && c != '\n') line += char(c);
+            if (c == EOF && line.empty()) break;
+            size_t start = line.find_first_not_of(" \t\r");
+            if (start == std::string::npos || line[start] == '#') continue;
+
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                space_free.wait(lock, [this] { return read - written < WINDOW; });
+                index = read;
+                jobs[index % WINDOW].scramble = line;
+                ++read;
+                ++pending;
+            }
+            WorkQueue &q = queues[next++ % queues.size()];
+            {
+                std::lock_guard<std::mutex> lock(q.mutex);
+                q.items.push_back(index);
+            }
+            work_ready.notify_one();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        eof = true;
+        work_ready.notify_all();
+        result_ready.notify_one();
+    }
+
+    bool take(size_t self, size_t &index) {
+        for (size_t k = 0; k < queues.size(); ++k) {
+            WorkQueue &q = queues[(self + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.items.empty()) continue;
+            if (k == 0) {
+                index = q.items.front();
+                q.items.pop_front();
+            } else {
+                index = q.items.back();
+                q.items.pop_back();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void work(size_t self) {
+        for (;;) {
+            size_t index;
+            if (!take(self, index)) {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (pending == 0 && eof) return;
+                work_ready.wait_for(lock, std::chrono::milliseconds(10), [this] { return pending > 0 || eof; });
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --pending;
+            }
+
+            // The slot is not reused before it is written, so it is ours alone
+            Job &job = jobs[index % WINDOW];
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            job.output = solveOne(job.scramble);
+            job.ms = secondsSince(start) * 1000.0;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            job.done = true;
+            if (index == written) result_ready.notify_one();
+        }
+    }
+
+    std::string solveOne(const std::string &scramble) const {
+        MoveSequence moves, solution;
+        std::string error;
+        if (!moves.parse(scramble, &error)) return "error: " + error + "\t0";
+        CubeState state;
+        state.multiply(moves.permutation());
+        if (!solver.solve(state, solution, &error)) return "error: " + error + "\t0";
+        return solution.toString() + "\t" + std::to_string(solution.size());
+    }
+
+    const Solver &solver;
+    std::vector<Job> jobs;              // ring of WINDOW slots, by input index
+    std::vector<WorkQueue> queues;
+
+    std::mutex mutex;                   // guards the counters and Job::done
+    std::condition_variable work_ready, result_ready, space_free;
+    size_t pending;                     // queued, not yet taken
+    size_t read, written;
+    bool eof;
+};
+
+} // namespace
+
+static double percentile(const std::vector<double> &sorted, double p) {
+    if (sorted.empty()) return 0;
+    return sorted[std::min(sorted.size() - 1, size_t(p * sorted.size()))];
+}
+
+int main(int argc, char **argv) {
+    std::string solver_name = "two-phase", path;
+    int threads = int(std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--solver") == 0 && i + 1 < argc) solver_name = argv[++i];
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            fprintf(stderr, "usage: %s [--solver two-phase|thistlethwaite|cfop|optimal|pocket] [--threads n] [file]\n", argv[0]);
+            return 1;
+        } else path = argv[i];
+    }
+    if (threads < 1) threads = 1;
+    logToStderr();
+
+    // Each worker runs whole solves, so the optimal solver searches single-threaded
+    std::unique_ptr<Solver> solver;
+    if (solver_name == "two-phase") solver.reset(new TwoPhaseSolver());
+    else if (solver_name == "thistlethwaite") solver.reset(new ThistlethwaiteSolver());
+    else if (solver_name == "cfop") solver.reset(new CfopSolver());
+    else if (solver_name == "optimal") solver.reset(new OptimalSolver(1));
+    else if (solver_name == "pocket") solver.reset(new PocketSolver());
+    else {
+        fprintf(stderr, "unknown solver %s\n", solver_name.c_str());
+        return 1;
+    }
+
+    FILE *in = stdin;
+    if (!path.empty() && path != "-") {
+        in = fopen(path.c_str(), "r");
+        if (!in) {
+            fprintf(stderr, "cannot open %s\n", path.c_str());
+            return 1;
+        }
+    }
+
+    std::vector<double> latencies;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    BatchRunner runner(*solver, threads);
+    runner.run(in, stdout, latencies);
+    double seconds = secondsSince(start);
+    if (in != stdin) fclose(in);
+
+    double total = 0;
+    for (size_t i = 0; i < latencies.size(); ++i) total += latencies[i];
+    std::sort(latencies.begin(), latencies.end());
+    logFlush();
+    fprintf(stderr, "%zu scrambles, %s, %d threads: %.2f s, %.1f solves/s\n", latencies.size(), solver->name(),
+            threads, seconds, seconds > 0 ? latencies.size() / seconds : 0.0);
+    fprintf(stderr, "latency ms: avg %.3f  p50 %.3f  p90 %.3f  p99 %.3f  max %.3f\n",
+            latencies.empty() ? 0.0 : total / latencies.size(), percentile(latencies, 0.5),
+            percentile(latencies, 0.9), percentile(latencies, 0.99), latencies.empty() ? 0.0 : latencies.back());
+    return 0;
+}
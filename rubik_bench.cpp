@@ -0,0 +1,344 @@
+// Headless benchmark for librubik: replays a random move stream through the
+// cubie move tables and the facelet shuffle engine, measures how the
+// optimal solver's search throughput scales with threads, or compares the
+// suboptimal solvers' solution lengths against their table sizes (with the
+// time CFOP spends in each step), times the parallel breadth-first
+// search over every 2x2 state, whose depth counts are known exactly,
+// measures face and slice turns of a very large sticker cube, or breaks
+// the big-cube reduction solver down by stage for each size.
+//
+// usage: rubik_bench [moves]
+//        rubik_bench optimal [scramble_moves] [max_threads]
+//        rubik_bench solvers [scrambles]
+//        rubik_bench pocket [max_threads]
+//        rubik_bench big [size] [turns] [max_threads]
+//        rubik_bench reduction [scrambles]
+#include "MoveTables.h"
+#include "FaceletEngine.h"
+#include "OptimalSolver.h"
+#include "TwoPhaseSolver.h"
+#include "ThistlethwaiteSolver.h"
+#include "CfopSolver.h"
+#include "PocketCube.h"
+#include "BigCube.h"
+#include "ReductionSolver.h"
+#include <algorithm>
+#include <map>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Solves the same scrambles with 1, 2, 4 ... max_threads threads
+static int benchOptimal(int scramble_moves, int max_threads) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    korfTables();
+    printf("pattern databases: %.1f s\n", secondsSince(start));
+
+    std::vector<CubeState> scrambles(4);
+    srand(12345);
+    for (size_t i = 0; i < scrambles.size(); ++i) {
+        // No two turns of the same face in a row, so the scrambles stay deep
+        int last_face = -1;
+        for (int m = 0; m < scramble_moves; ++m) {
+            Move move;
+            do move = Move(rand() % NUM_FACE_MOVES); while (moveTurn(move) == last_face);
+            last_face = moveTurn(move);
+            applyMove(scrambles[i], move);
+        }
+    }
+
+    double base_rate = 0;
+    for (int threads = 1;; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+        OptimalSolver solver(threads);
+        unsigned long long nodes = 0;
+        double seconds = 0, busy = 0;
+        size_t length = 0;
+        for (size_t i = 0; i < scrambles.size(); ++i) {
+            MoveSequence solution;
+            OptimalSearchStats stats;
+            std::string error;
+            if (!solver.solve(scrambles[i], solution, &error, &stats)) {
+                printf("solve failed: %s\n", error.c_str());
+                return 1;
+            }
+            nodes += stats.totalNodes();
+            seconds += stats.seconds;
+            for (size_t t = 0; t < stats.threadSeconds.size(); ++t) busy += stats.threadSeconds[t];
+            length += solution.size();
+        }
+
+        double rate = nodes / seconds;
+        if (threads == 1) base_rate = rate;
+        printf("threads %2d: %6.2f s  %8.2f M nodes/s  %6.2f M nodes/s per thread  scaling %.2fx  (avg length %.1f)\n",
+               threads, seconds, rate / 1e6, nodes / busy / 1e6, rate / base_rate,
+               double(length) / scrambles.size());
+        if (threads == max_threads) break;
+    }
+    return 0;
+}
+
+static size_t tableBytes(const TableSet &tables) {
+    size_t total = 0;
+    for (size_t i = 0; i < tables.getSections().size(); ++i) total += tables.getSections()[i].size;
+    return total;
+}
+
+// Solution length, time and table memory of each suboptimal solver on the
+// same random scrambles
+static int benchSolvers(int count) {
+    std::vector<CubeState> scrambles(count);
+    srand(12345);
+    for (size_t i = 0; i < scrambles.size(); ++i)
+        for (int m = 0; m < 40; ++m) applyMove(scrambles[i], Move(rand() % NUM_FACE_MOVES));
+
+    TwoPhaseSolver two_phase;
+    ThistlethwaiteSolver thistle;
+    CfopSolver cfop;
+    const Solver *solvers[3] = {&two_phase, &thistle, &cfop};
+    size_t bytes[3] = {tableBytes(twoPhaseTables().sections), tableBytes(thistlethwaiteTables().sections),
+                       tableBytes(cfopTables().sections)};
+
+    for (int k = 0; k < 3; ++k) {
+        size_t length = 0, longest = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < scrambles.size(); ++i) {
+            MoveSequence solution;
+            std::string error;
+            if (!solvers[k]->solve(scrambles[i], solution, &error)) {
+                printf("%s: solve failed: %s\n", solvers[k]->name(), error.c_str());
+                return 1;
+            }
+            length += solution.size();
+            if (solution.size() > longest) longest = solution.size();
+        }
+        double seconds = secondsSince(start);
+        printf("%-15s tables %5.1f MB  avg length %5.2f  max %2zu  %8.3f ms/solve\n", solvers[k]->name(),
+               bytes[k] / 1048576.0, double(length) / scrambles.size(), longest, seconds * 1000.0 / scrambles.size());
+    }
+
+    // CFOP step breakdown; F2L pairs are summed, last-layer cases by step
+    const char *steps[4] = {"cross", "F2L", "OLL", "PLL"};
+    std::map<std::string, double> step_moves, step_ms;
+    for (size_t i = 0; i < scrambles.size(); ++i) {
+        MoveSequence solution;
+        std::vector<CfopStage> stages;
+        cfop.solve(scrambles[i], solution, NULL, &stages);
+        for (size_t s = 0; s < stages.size(); ++s) {
+            std::string step = stages[s].name == "AUF" ? "PLL" : stages[s].name.substr(0, stages[s].name.find(' '));
+            step_moves[step] += stages[s].moves.size();
+            step_ms[step] += stages[s].seconds * 1000.0;
+        }
+    }
+    for (int s = 0; s < 4; ++s)
+        printf("  cfop %-5s  %5.2f moves  %8.3f ms\n", steps[s], step_moves[steps[s]] / scrambles.size(),
+               step_ms[steps[s]] / scrambles.size());
+    return 0;
+}
+
+// States of the 2x2 at each face-turn distance from solved
+static const uint64_t POCKET_COUNTS[POCKET_MAX_DEPTH + 1] = {
+    1, 9, 54, 321, 1847, 9992, 50136, 227536, 870072, 1887748, 623800, 2644
+};
+
+static int benchPocket(int max_threads) {
+    const PocketTables &t = pocketTables();
+    std::vector<uint8_t> reference;
+    double base_seconds = 0;
+    for (int threads = 1;; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+        std::vector<uint8_t> table(POCKET_STATES / 4);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::vector<uint64_t> counts = buildPocketTable(t, table.data(), threads);
+        double seconds = secondsSince(start);
+        if (threads == 1) base_seconds = seconds;
+
+        bool ok = counts.size() == POCKET_MAX_DEPTH + 1 &&
+                  std::equal(counts.begin(), counts.end(), POCKET_COUNTS) &&
+                  (reference.empty() || table == reference);
+        if (reference.empty()) reference = table;
+        printf("threads %2d: %6.3f s  %7.2f M states/s  scaling %.2fx  %s\n", threads, seconds,
+               POCKET_STATES / seconds / 1e6, base_seconds / seconds, ok ? "counts ok" : "MISMATCH");
+        if (!ok) return 1;
+        if (threads == max_threads) break;
+    }
+
+    // Optimal solves of random states
+    PocketSolver solver;
+    std::vector<CubeState> scrambles(10000);
+    srand(12345);
+    for (size_t i = 0; i < scrambles.size(); ++i)
+        for (int m = 0; m < 30; ++m) applyMove(scrambles[i], Move(rand() % NUM_FACE_MOVES));
+    size_t length = 0, longest = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < scrambles.size(); ++i) {
+        MoveSequence solution;
+        std::string error;
+        if (!solver.solve(scrambles[i], solution, &error)) {
+            printf("solve failed: %s\n", error.c_str());
+            return 1;
+        }
+        length += solution.size();
+        if (solution.size() > longest) longest = solution.size();
+    }
+    double seconds = secondsSince(start);
+    printf("%-15s table %5.2f MB  avg length %5.2f  max %2zu  %8.4f ms/solve\n", solver.name(),
+           tableBytes(t.sections) / 1048576.0, double(length) / scrambles.size(), longest,
+           seconds * 1000.0 / scrambles.size());
+    return 0;
+}
+
+// Outer-layer turns (a whole face plus its ring) and inner slice turns of
+// an N x N x N sticker cube, then the same turns undone to check the result
+static int benchBig(int n, int turns, int max_threads) {
+    BigCube cube(n);
+    printf("%dx%dx%d: %.1f MB of stickers\n", n, n, n, cube.getStickers().size() / 1048576.0);
+
+    std::vector<int> faces(turns), layers(turns), inner(turns);
+    srand(12345);
+    for (int i = 0; i < turns; ++i) {
+        faces[i] = rand() % 6;
+        layers[i] = (faces[i] & 1) ? -(n / 2) : n / 2;
+        inner[i] = BigCube::layerCoord(n, 1 + rand() % (n - 2));
+    }
+
+    std::vector<uint8_t> reference;
+    for (int threads = 1;; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+        cube.reset();
+        cube.setThreads(threads);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < turns; ++i) cube.turn(faces[i], layers[i], true);
+        double face_seconds = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < turns; ++i) cube.turn(faces[i], inner[i], true);
+        double slice_seconds = secondsSince(start);
+
+        bool ok = reference.empty() || cube.getStickers() == reference;
+        if (reference.empty()) reference = cube.getStickers();
+        for (int i = turns - 1; i >= 0; --i) cube.turn(faces[i], inner[i], false);
+        for (int i = turns - 1; i >= 0; --i) cube.turn(faces[i], layers[i], false);
+        ok = ok && cube.isSolved();
+
+        // Each sticker moved is read and written once
+        double face_bytes = 2.0 * turns * (double(n) * n + 4.0 * n);
+        printf("threads %2d: face %9.1f turns/s %6.2f GB/s  slice %10.0f turns/s  %s\n", threads,
+               turns / face_seconds, face_bytes / face_seconds / 1e9, turns / slice_seconds,
+               ok ? "ok" : "MISMATCH");
+        if (!ok) return 1;
+        if (threads == max_threads) break;
+    }
+    return 0;
+}
+
+// Moves and time of each reduction stage on random scrambles of every size
+static int benchReduction(int count) {
+    ReductionSolver solver;
+    srand(12345);
+    for (int n = REDUCTION_MIN_SIZE; n <= REDUCTION_MAX_SIZE; ++n) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const ReductionTables &t = reductionTables(n);
+        double table_seconds = secondsSince(start);
+        size_t algs = 0;
+        for (size_t k = 0; k < t.centers.size(); ++k) algs += t.centers[k].algs.size();
+        for (size_t k = 0; k < t.wings.size(); ++k) algs += t.wings[k].algs.size();
+
+        std::vector<std::string> names;
+        std::map<std::string, double> stage_moves, stage_ms;
+        size_t length = 0;
+        double seconds = 0, slowest = 0;
+        for (int i = 0; i < count; ++i) {
+            BigCube cube(n);
+            for (int m = 0; m < 40 * n; ++m) cube.turn(rand() % 6, BigCube::layerCoord(n, rand() % n), rand() % 2 != 0);
+
+            std::vector<BigMove> solution;
+            std::vector<ReductionStage> stages;
+            std::string error;
+            start = std::chrono::steady_clock::now();
+            bool ok = solver.solve(cube, solution, &error, &stages);
+            double s = secondsSince(start);
+            cube.apply(solution);
+            if (!ok || !cube.isSolved()) {
+                printf("%dx%dx%d: solve failed: %s\n", n, n, n, ok ? "not solved" : error.c_str());
+                return 1;
+            }
+            length += solution.size();
+            seconds += s;
+            slowest = std::max(slowest, s);
+            for (size_t k = 0; k < stages.size(); ++k) {
+                if (i == 0) names.push_back(stages[k].name);
+                stage_moves[stages[k].name] += stages[k].moves.size();
+                stage_ms[stages[k].name] += stages[k].seconds * 1000.0;
+            }
+        }
+        printf("%dx%dx%d: %6zu three-cycles in %5.1f ms  avg length %6.1f  %7.3f ms/solve  max %7.3f ms\n", n, n, n,
+               algs, table_seconds * 1000.0, double(length) / count, seconds * 1000.0 / count, slowest * 1000.0);
+        for (size_t k = 0; k < names.size(); ++k)
+            printf("  %-8s %6.1f moves  %7.3f ms\n", names[k].c_str(), stage_moves[names[k]] / count,
+                   stage_ms[names[k]] / count);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "reduction") == 0) {
+        int count = (argc > 2) ? atoi(argv[2]) : 100;
+        return benchReduction(count > 0 ? count : 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "big") == 0) {
+        int n = (argc > 2) ? atoi(argv[2]) : 1000;
+        int turns = (argc > 3) ? atoi(argv[3]) : 200;
+        int max_threads = (argc > 4) ? atoi(argv[4]) : int(std::thread::hardware_concurrency());
+        return benchBig(std::max(n, 3), std::max(turns, 1), max_threads > 0 ? max_threads : 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "pocket") == 0) {
+        int max_threads = (argc > 2) ? atoi(argv[2]) : int(std::thread::hardware_concurrency());
+        return benchPocket(max_threads > 0 ? max_threads : 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "solvers") == 0) {
+        int count = (argc > 2) ? atoi(argv[2]) : 200;
+        return benchSolvers(count > 0 ? count : 1);
+    }
+    if (argc > 1 && strcmp(argv[1], "optimal") == 0) {
+        int scramble_moves = (argc > 2) ? atoi(argv[2]) : 12;
+        int max_threads = (argc > 3) ? atoi(argv[3]) : int(std::thread::hardware_concurrency());
+        return benchOptimal(scramble_moves, max_threads > 0 ? max_threads : 1);
+    }
+
+    size_t count = (argc > 1) ? strtoul(argv[1], NULL, 10) : 10000000;
+    if (count == 0) count = 1;
+
+    std::vector<Move> moves(count);
+    srand(12345);
+    for (size_t i = 0; i < count; ++i) moves[i] = Move(rand() % NUM_MOVES);
+
+    // Build tables outside the timed regions
+    moveTables();
+    FaceletEngine::kernelName();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    CubeState state;
+    applyMoves(state, moves.data(), count);
+    double cubie_time = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    FaceletCube facelets;
+    FaceletEngine::applyMoves(facelets, moves.data(), count);
+    double facelet_time = secondsSince(start);
+
+    bool agree = (FaceletCube(state) == facelets);
+
+    printf("moves:            %zu\n", count);
+    printf("cubie tables:     %8.1f M moves/s\n", count / cubie_time / 1e6);
+    printf("facelet engine:   %8.1f M moves/s (%s)\n", count / facelet_time / 1e6, FaceletEngine::kernelName());
+    printf("results agree:    %s\n", agree ? "yes" : "NO");
+    return agree ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+// Generates the solvers' lookup tables and writes them to one table file,
+// which the solvers then map at startup instead of regenerating.
+//
+// usage: rubik_tables [path]             generate (default $RUBIK_TABLES or rubik_tables.bin)
+//        rubik_tables --verify [path]    check an existing file
+#include "TableFile.h"
+#include "TwoPhaseSolver.h"
+#include "OptimalSolver.h"
+#include "ThistlethwaiteSolver.h"
+#include "CfopSolver.h"
+#include "PocketCube.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static int verify(const std::string &path) {
+    TableFile file;
+    std::string error;
+    if (!file.open(path, &error) || !file.verify(&error)) {
+        printf("%s\n", error.c_str());
+        return 1;
+    }
+    size_t total = 0;
+    for (size_t i = 0; i < file.getSections().size(); ++i) {
+        const TableSection &s = file.getSections()[i];
+        printf("  %-32s %10zu bytes\n", s.name.c_str(), s.size);
+        total += s.size;
+    }
+    printf("%s: %zu sections, %.1f MB, checksums ok\n", path.c_str(), file.getSections().size(), total / 1048576.0);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--verify") == 0)
+        return verify(argc > 2 ? argv[2] : tableFilePath());
+
+    std::string path = argc > 1 ? argv[1] : tableFilePath();
+    if (path.empty()) {
+        printf("no table file path\n");
+        return 1;
+    }
+
+    // Generate everything in-process rather than mapping an older file
+    setTableFilePath("");
+    std::vector<TableSection> sections;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const TwoPhaseTables &two_phase = twoPhaseTables();
+    sections.insert(sections.end(), two_phase.sections.getSections().begin(), two_phase.sections.getSections().end());
+    printf("two-phase tables:  %6.1f s\n", secondsSince(start));
+
+    start = std::chrono::steady_clock::now();
+    const ThistlethwaiteTables &thistle = thistlethwaiteTables();
+    sections.insert(sections.end(), thistle.sections.getSections().begin(), thistle.sections.getSections().end());
+    printf("four-phase tables: %6.1f s\n", secondsSince(start));
+
+    start = std::chrono::steady_clock::now();
+    const CfopTables &cfop = cfopTables();
+    sections.insert(sections.end(), cfop.sections.getSections().begin(), cfop.sections.getSections().end());
+    printf("CFOP tables:       %6.1f s\n", secondsSince(start));
+
+    start = std::chrono::steady_clock::now();
+    const PocketTables &pocket = pocketTables();
+    sections.insert(sections.end(), pocket.sections.getSections().begin(), pocket.sections.getSections().end());
+    printf("2x2 table:         %6.1f s\n", secondsSince(start));
+
+    start = std::chrono::steady_clock::now();
+    const KorfTables &korf = korfTables();
+    sections.insert(sections.end(), korf.sections.getSections().begin(), korf.sections.getSections().end());
+    printf("pattern databases: %6.1f s\n", secondsSince(start));
+
+    std::string error;
+    if (!TableFile::write(path, sections, &error)) {
+        printf("%s\n", error.c_str());
+        return 1;
+    }
+    return verify(path);
+}
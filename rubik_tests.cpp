@@ -0,0 +1,401 @@
+// Unit tests for librubik: notation and rotation round-trips, table files,
+// the facelet kernels against each other and the cubie model, the move
+// queue, the big cube against the 3x3x3, and every solver on random
+// scrambles. Each group runs on its own so ctest can list them; with no
+// argument all groups run. Solver tables are generated in-process.
+//
+// usage: rubik_tests [group]
+#include "MoveTables.h"
+#include "MoveSequence.h"
+#include "FaceletEngine.h"
+#include "TableFile.h"
+#include "MoveQueue.h"
+#include "BigCube.h"
+#include "TwoPhaseSolver.h"
+#include "ThistlethwaiteSolver.h"
+#include "CfopSolver.h"
+#include "OptimalSolver.h"
+#include "PocketCube.h"
+#include "ReductionSolver.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++failures;                                                    \
+        }                                                                  \
+    } while (0)
+
+static CubeState scrambled(int length) {
+    CubeState state;
+    for (int m = 0; m < length; ++m) applyMove(state, Move(rand() % NUM_FACE_MOVES));
+    return state;
+}
+
+// --------------- notation ---------------------------------------------------
+static void testNotation() {
+    struct { const char *text, *expected; } cases[] = {
+        {"R U R' U'", "R U R' U'"},
+        {"R R", "R2"},
+        {"R R'", ""},
+        {"R L R", "R2 L"},
+        {"(R U)2", "R U R U"},
+        {"F2' B3", "F2 B'"},
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        MoveSequence seq;
+        std::string error;
+        CHECK(seq.parse(cases[i].text, &error));
+        CHECK(seq.toString() == cases[i].expected);
+    }
+
+    // Wide turns and rotations expand to face and slice moves
+    MoveSequence wide, expanded;
+    CHECK(wide.parse("Rw"));
+    CHECK(expanded.parse("R M'"));
+    CHECK(wide.permutation() == expanded.permutation());
+    CHECK(wide.parse("x"));
+    CHECK(expanded.parse("R M' L'"));
+    CHECK(wide.permutation() == expanded.permutation());
+
+    const char *bad[] = {"R0", "R100", "Q", "(R U", "R U)", "(R)0", "((((R U)99)99)99)99"};
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        MoveSequence seq;
+        std::string error;
+        CHECK(!seq.parse(bad[i], &error));
+        CHECK(!error.empty());
+    }
+    std::string deep(MOVE_MAX_NESTING + 1, '(');
+    deep += "R" + std::string(MOVE_MAX_NESTING + 1, ')');
+    MoveSequence seq;
+    CHECK(!seq.parse(deep));
+
+    // format -> parse gives back the same moves
+    srand(12345);
+    for (int i = 0; i < 200; ++i) {
+        MoveSequence a, b;
+        for (int m = 0; m < 30; ++m) a.append(Move(rand() % NUM_MOVES));
+        CHECK(b.parse(a.toString()));
+        CHECK(a.getMoves() == b.getMoves());
+        CubeState s = a.permutation();
+        s.multiply(a.inverse().permutation());
+        CHECK(s.isSolved());
+    }
+}
+
+// --------------- rotations --------------------------------------------------
+static void testRotations() {
+    // Every move is made by its startRotation arguments
+    for (int m = 0; m < NUM_MOVES; ++m) {
+        int face, layer;
+        bool clockwise;
+        int times = rotationForMove(Move(m), face, layer, clockwise);
+        CHECK(times == (movePower(m) == 2 ? 2 : 1));
+        CubeState a, b;
+        applyMove(a, Move(m));
+        for (int k = 0; k < times; ++k) applyMove(b, moveForRotation(face, layer, clockwise));
+        CHECK(a == b);
+    }
+    // ... and every rotation by its move
+    for (int face = 0; face < 6; ++face)
+        for (int layer = -1; layer <= 1; ++layer)
+            for (int cw = 0; cw < 2; ++cw) {
+                Move move = moveForRotation(face, layer, cw != 0);
+                int f, l;
+                bool c;
+                CHECK(rotationForMove(move, f, l, c) == 1);
+                CubeState a, b;
+                applyMove(a, move);
+                applyMove(b, moveForRotation(f, l, c));
+                CHECK(a == b);
+                applyMove(a, moveForRotation(face, layer, cw == 0));
+                CHECK(a.isSolved());
+            }
+}
+
+// --------------- table files ------------------------------------------------
+static void testTableFile() {
+    const std::string path = "rubik_tests_tables.bin";
+    std::vector<uint8_t> small(100), large(10000);
+    for (size_t i = 0; i < small.size(); ++i) small[i] = uint8_t(i * 7 + 3);
+    for (size_t i = 0; i < large.size(); ++i) large[i] = uint8_t(i * 13 + i / 251);
+    std::vector<TableSection> sections;
+    TableSection a = {"test.small", small.data(), small.size()};
+    TableSection b = {"test.large", large.data(), large.size()};
+    sections.push_back(a);
+    sections.push_back(b);
+
+    std::string error;
+    CHECK(TableFile::write(path, sections, &error));
+    {
+        TableFile file;
+        CHECK(file.open(path, &error));
+        CHECK(file.getSections().size() == 2);
+        const void *data = file.find("test.small", small.size());
+        CHECK(data && memcmp(data, small.data(), small.size()) == 0);
+        data = file.findVerified("test.large", large.size(), &error);
+        CHECK(data && memcmp(data, large.data(), large.size()) == 0);
+        CHECK(!file.find("test.small", small.size() + 1));
+        CHECK(!file.find("test.missing", small.size()));
+        CHECK(file.verify(&error));
+    }
+
+    // Flip one byte of the large section: it opens, but no longer verifies
+    FILE *f = fopen(path.c_str(), "r+b");
+    CHECK(f != NULL);
+    if (f) {
+        std::vector<uint8_t> bytes;
+        uint8_t buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) bytes.insert(bytes.end(), buf, buf + n);
+        size_t at = 0;
+        for (size_t i = 0; i + large.size() <= bytes.size(); ++i)
+            if (memcmp(&bytes[i], large.data(), large.size()) == 0) { at = i + 5000; break; }
+        CHECK(at != 0);
+        fseek(f, long(at), SEEK_SET);
+        fputc(bytes[at] ^ 1, f);
+        fclose(f);
+
+        TableFile file;
+        CHECK(file.open(path, &error));
+        CHECK(file.find("test.large", large.size()) != NULL);
+        CHECK(file.findVerified("test.large", large.size(), &error) == NULL);
+        CHECK(file.findVerified("test.small", small.size()) != NULL);
+        CHECK(!file.verify(&error));
+    }
+
+    // Not a table file
+    f = fopen(path.c_str(), "wb");
+    if (f) {
+        fputs("not a table file", f);
+        fclose(f);
+    }
+    TableFile file;
+    CHECK(!file.open(path, &error));
+    remove(path.c_str());
+}
+
+// --------------- facelets ---------------------------------------------------
+static void testFacelets() {
+    srand(12345);
+    std::vector<Move> moves(5000);
+    for (size_t i = 0; i < moves.size(); ++i) moves[i] = Move(rand() % NUM_MOVES);
+
+    // Reference: the cubie model
+    CubeState state;
+    applyMoves(state, moves.data(), moves.size());
+    FaceletCube expected(state);
+
+    // The per-move permutations
+    FaceletCube cube;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const uint8_t *p = FaceletEngine::permutation(moves[i]);
+        FaceletCube next;
+        for (int k = 0; k < NUM_FACELETS; ++k) next.stickers[k] = cube.stickers[p[k]];
+        cube = next;
+    }
+    CHECK(cube == expected);
+
+    // Every kernel this CPU runs, in one stream and move by move, on
+    // cubes at each 16-byte offset into a vector
+    const char *kernels[] = {"scalar", "ssse3", "avx2", "neon"};
+    int ran = 0;
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k) {
+        std::vector<FaceletCube> cubes(4);
+        if (!FaceletEngine::applyMovesWith(kernels[k], cubes[0], moves.data(), moves.size())) continue;
+        ++ran;
+        printf("facelet kernel %s\n", kernels[k]);
+        CHECK(cubes[0] == expected);
+        for (size_t c = 1; c < cubes.size(); ++c) {
+            for (size_t i = 0; i < moves.size(); i += c)
+                FaceletEngine::applyMovesWith(kernels[k], cubes[c], &moves[i], std::min(c, moves.size() - i));
+            CHECK(cubes[c] == expected);
+        }
+    }
+    CHECK(ran >= 1);
+
+    FaceletCube picked;
+    FaceletEngine::applyMoves(picked, moves.data(), moves.size());
+    CHECK(picked == expected);
+}
+
+// --------------- move queue -------------------------------------------------
+static void testMoveQueue() {
+    for (int face = 0; face < 6; ++face)
+        for (int layer = -10; layer <= 10; ++layer) {
+            MoveRecord r = MoveRecord::unpack(MoveRecord(face, layer, layer % 2 == 0, MOVE_FLAG_TURBO).pack());
+            CHECK(r.face == face && r.layer == layer && r.clockwise == (layer % 2 == 0) && r.flags == MOVE_FLAG_TURBO);
+        }
+
+    MoveQueue small(4);
+    MoveRecord r;
+    CHECK(!small.pop(r));
+    for (int i = 0; i < 4; ++i) CHECK(small.push(MoveRecord(i)));
+    CHECK(!small.push(MoveRecord(5)));
+    for (int i = 0; i < 4; ++i) CHECK(small.pop(r) && r.face == i);
+    CHECK(!small.pop(r));
+
+    // Several producers, one consumer: every record arrives once, and in
+    // order per producer
+    const int producers = 4, per_producer = 20000;
+    MoveQueue queue(256);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+        threads.push_back(std::thread([&queue, p]() {
+            for (int i = 0; i < per_producer; ++i)
+                while (!queue.push(MoveRecord(p, 0, true, uint8_t(i & 255)))) std::this_thread::yield();
+        }));
+    std::vector<int> received(producers, 0);
+    for (int n = 0; n < producers * per_producer;) {
+        if (!queue.pop(r)) {
+            std::this_thread::yield();
+            continue;
+        }
+        CHECK(r.face >= 0 && r.face < producers);
+        if (r.face < 0 || r.face >= producers) break;
+        CHECK(r.flags == uint8_t(received[r.face] & 255));
+        ++received[r.face];
+        ++n;
+    }
+    for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+    for (int p = 0; p < producers; ++p) CHECK(received[p] == per_producer);
+    CHECK(!queue.pop(r));
+}
+
+// --------------- big cube ---------------------------------------------------
+static void testBigCube() {
+    // BigCube(3) turns as the cubie model does
+    srand(12345);
+    BigCube big(3);
+    CubeState state;
+    for (int i = 0; i < 500; ++i) {
+        int face = rand() % 6, layer = rand() % 3 - 1;
+        bool clockwise = rand() % 2 != 0;
+        big.turn(face, layer, clockwise);
+        applyMove(state, moveForRotation(face, layer, clockwise));
+    }
+    uint8_t facelets[NUM_FACELETS];
+    state.getFacelets(facelets);
+    CHECK(memcmp(big.getStickers().data(), facelets, NUM_FACELETS) == 0);
+
+    // Moves and their notation round-trip, and undo each other
+    for (int n = 2; n <= 7; ++n) {
+        BigCube cube(n);
+        std::vector<int> faces, layers;
+        std::vector<bool> turns;
+        for (int i = 0; i < 100; ++i) {
+            int face = rand() % 6, layer = BigCube::layerCoord(n, rand() % n);
+            bool clockwise = rand() % 2 != 0;
+            BigMove move = bigMoveForRotation(n, face, layer, clockwise);
+            int f, l;
+            bool c;
+            int times = bigMoveRotation(n, move, f, l, c);
+            BigCube a(cube), b(cube);
+            a.turn(face, layer, clockwise);
+            for (int k = 0; k < times; ++k) b.turn(f, l, c);
+            CHECK(a == b);
+            cube.turn(face, layer, clockwise);
+            faces.push_back(face);
+            layers.push_back(layer);
+            turns.push_back(clockwise);
+        }
+        CHECK(!cube.isSolved());
+        for (size_t i = faces.size(); i-- > 0;) cube.turn(faces[i], layers[i], !turns[i]);
+        CHECK(cube.isSolved());
+    }
+}
+
+// --------------- solvers ----------------------------------------------------
+static void checkSolver(const Solver &solver, int count, int scramble_length) {
+    srand(12345);
+    for (int i = 0; i < count; ++i) {
+        CubeState state = scrambled(scramble_length);
+        MoveSequence solution;
+        std::string error;
+        bool ok = solver.solve(state, solution, &error);
+        if (!ok) printf("%s: solve failed: %s\n", solver.name(), error.c_str());
+        CHECK(ok);
+        state.multiply(solution.permutation());
+        CHECK(state.isSolved());
+    }
+}
+
+static void testSolvers() {
+    checkSolver(TwoPhaseSolver(), 50, 40);
+    checkSolver(ThistlethwaiteSolver(), 50, 40);
+    checkSolver(CfopSolver(), 50, 40);
+}
+
+static void testOptimal() {
+    checkSolver(OptimalSolver(1), 5, 10);
+}
+
+static void testPocket() {
+    // U, R and F only, so the DBL corner stays home and solved means solved
+    PocketSolver solver;
+    const Move turns[] = {MOVE_U, MOVE_U2, MOVE_U3, MOVE_R, MOVE_R2, MOVE_R3, MOVE_F, MOVE_F2, MOVE_F3};
+    srand(12345);
+    for (int i = 0; i < 100; ++i) {
+        CubeState state;
+        for (int m = 0; m < 30; ++m) applyMove(state, turns[rand() % 9]);
+        MoveSequence solution;
+        std::string error;
+        CHECK(solver.solve(state, solution, &error));
+        CHECK(solution.size() <= size_t(POCKET_MAX_DEPTH));
+        state.multiply(solution.permutation());
+        CHECK(pocketIndex(state) == pocketIndex(CubeState()));
+    }
+}
+
+static void testReduction() {
+    ReductionSolver solver;
+    srand(12345);
+    for (int n = REDUCTION_MIN_SIZE; n <= REDUCTION_MAX_SIZE; ++n)
+        for (int i = 0; i < 3; ++i) {
+            BigCube cube(n);
+            for (int m = 0; m < 40 * n; ++m) cube.turn(rand() % 6, BigCube::layerCoord(n, rand() % n), rand() % 2 != 0);
+            std::vector<BigMove> solution;
+            std::string error;
+            bool ok = solver.solve(cube, solution, &error);
+            if (!ok) printf("%dx%dx%d: solve failed: %s\n", n, n, n, error.c_str());
+            CHECK(ok);
+            cube.apply(solution);
+            CHECK(cube.isSolved());
+        }
+    std::vector<BigMove> solution;
+    CHECK(!solver.solve(BigCube(3), solution));
+}
+
+// ---------------------------------------------------------------------------
+int main(int argc, char **argv) {
+    struct { const char *name; void (*run)(); } groups[] = {
+        {"notation", testNotation},   {"rotations", testRotations}, {"tablefile", testTableFile},
+        {"facelets", testFacelets},   {"queue", testMoveQueue},     {"bigcube", testBigCube},
+        {"solvers", testSolvers},     {"optimal", testOptimal},     {"pocket", testPocket},
+        {"reduction", testReduction},
+    };
+    setTableFilePath("");
+
+    bool found = false;
+    for (size_t i = 0; i < sizeof(groups) / sizeof(groups[0]); ++i) {
+        if (argc > 1 && strcmp(argv[1], groups[i].name) != 0) continue;
+        found = true;
+        int before = failures;
+        groups[i].run();
+        printf("%-10s %s\n", groups[i].name, failures == before ? "ok" : "FAILED");
+    }
+    if (!found) {
+        printf("unknown test group: %s\n", argv[1]);
+        return 2;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -1,15 +1,49 @@
 #version 410
 
-in vec4 vPosition;
-in vec4 vColor;
+in vec3 vPosition;              // normalized 16-bit, corners at +-1
+in uint vFace;                  // face of the vertex, as the Face enum
+
+// Per cubie (instanced)
+in mat4 vModel;
+in ivec3 vCell;                 // grid position, in layer coordinates
 
 out vec4 color;
 
-uniform mat4 ModelView;
+uniform mat4 View;
 uniform mat4 Projection;
 
+// PALETTE index of each cubie face, six per cubie; 255 for inner faces
+uniform usamplerBuffer Stickers;
+uniform vec4 Palette[7];
+
+// The animating slice: cubies whose cell is SliceLayer along SliceAxis
+// (-1 when nothing turns) rotate SliceAngle degrees about SliceDirection,
+// through SliceCenter
+uniform int SliceAxis;
+uniform int SliceLayer;
+uniform vec3 SliceDirection;
+uniform float SliceAngle;
+uniform vec3 SliceCenter;
+
 void main()
 {
-    gl_Position = Projection * ModelView * vPosition;
-    color = vColor;
+    uint sticker = texelFetch(Stickers, gl_InstanceID * 6 + int(vFace)).r;
+
+    // Inner faces collapse to a point outside the view and draw nothing
+    if (sticker == 255u) {
+        color = vec4(0.0);
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        return;
+    }
+    color = Palette[sticker];
+
+    vec4 world = vModel * vec4(vPosition * 0.5, 1.0);
+    if (SliceAxis >= 0 && vCell[SliceAxis] == SliceLayer) {
+        // Rodrigues' rotation about the unit axis
+        float a = radians(SliceAngle);
+        vec3 p = world.xyz - SliceCenter;
+        p = p * cos(a) + cross(SliceDirection, p) * sin(a) + SliceDirection * dot(SliceDirection, p) * (1.0 - cos(a));
+        world.xyz = SliceCenter + p;
+    }
+    gl_Position = Projection * View * world;
 }
\ No newline at end of file